@@ -0,0 +1,266 @@
+// Micro-benchmarks for RSV hot paths.
+// Build with: cmake -DBUILD_BENCH=ON .. && make rsv_bench && ./rsv_bench
+
+#include <ftxui/dom/elements.hpp>
+#include <ftxui/dom/node.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "api/history_store.hpp"
+#include "api/job_table.hpp"
+#include "components/nodedetails.hpp"
+
+using namespace ftxui;
+
+namespace legacy {
+
+// Node panel as rendered before NodeGrid: one text() element per core/GPU
+inline Element renderNodeCell(const api::NodeAllocation& node) {
+    Element title = text(node.node_name) | color(Color::Cyan) | bold;
+
+    const int cores_per_line = 20;
+    std::vector<Element> core_lines;
+    int line_count = 0;
+    std::vector<Element> current_line;
+
+    current_line.push_back(text("Coeurs : "));
+
+    for (int i = 0; i < node.total_cores; ++i) {
+        if (node.allocated_cores.contains(i))
+            current_line.push_back(text("■") | color(Color::Green));
+        else
+            current_line.push_back(text("."));
+
+        line_count++;
+        if (line_count == cores_per_line) {
+            core_lines.push_back(hbox(current_line));
+            current_line.clear();
+            current_line.push_back(text("         "));
+            line_count = 0;
+        }
+    }
+
+    if (!current_line.empty()) {
+        while (line_count < cores_per_line) {
+            current_line.push_back(text("."));
+            line_count++;
+        }
+        core_lines.push_back(hbox(current_line));
+    }
+
+    std::vector<Element> gpu_line;
+    gpu_line.push_back(text("GPUs   : "));
+    for (int i = 0; i < node.total_gpus; ++i) {
+        if (node.allocated_gpus.contains(i))
+            gpu_line.push_back(text("● ") | color(Color::Yellow));
+        else
+            gpu_line.push_back(text("○ "));
+    }
+
+    return hbox({
+        hbox({text("  "), vbox({title, vbox(core_lines), text(" "), hbox(gpu_line)}), text("  ")}) | border,
+        text("  "),
+    });
+}
+
+inline Element nodeGrid(const api::DetailedJob& job, int width) {
+    std::vector<Element> all_elements;
+    int nodes_per_row = std::max(1, width / 44);
+
+    for (const auto& group : ui::groupNodesByApu(job)) {
+        all_elements.push_back(vbox({
+            text(""),
+            text("╔══════════════════════════════════════════════════════════╗") | color(Color::Magenta) | bold,
+            hbox({text("║ ") | color(Color::Magenta) | bold, text(group.display_name) | bold}),
+            hbox({text("║ ") | color(Color::Magenta) | bold, text("stats") | color(Color::Cyan)}),
+            text("╚══════════════════════════════════════════════════════════╝") | color(Color::Magenta) | bold,
+        }));
+
+        std::vector<std::vector<Element>> rows;
+        std::vector<Element> row;
+        for (const auto* node : group.nodes) {
+            row.push_back(renderNodeCell(*node));
+            if ((int)row.size() == nodes_per_row) {
+                rows.push_back(row);
+                row.clear();
+            }
+        }
+        if (!row.empty()) rows.push_back(row);
+        if (!rows.empty()) all_elements.push_back(gridbox(rows));
+    }
+
+    return vbox(all_elements);
+}
+
+}
+
+namespace {
+
+using BenchClock = std::chrono::steady_clock;
+
+api::DetailedJob syntheticJob(int nodes, int cores, int gpus) {
+    api::DetailedJob job;
+    job.id = "1";
+    for (int i = 0; i < nodes; ++i) {
+        api::NodeAllocation na;
+        char name[32];
+        std::snprintf(name, sizeof(name), "romeo-a%03d", i);
+        na.node_name = name;
+        na.node_prefix = api::nodeClassPrefix(na.node_name);
+        na.total_cores = cores;
+        na.total_gpus = gpus;
+        na.allocated_cores.insertRange(0, cores * 3 / 4 - 1);
+        na.allocated_gpus.insertRange(0, gpus / 2 - 1);
+        job.node_allocations.push_back(na);
+    }
+    return job;
+}
+
+// Average microseconds per call of f()
+template <typename F>
+double perFrameUs(int frames, F&& f) {
+    auto start = BenchClock::now();
+    for (int i = 0; i < frames; ++i) f(i);
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(BenchClock::now() - start).count();
+    return (double)us / frames;
+}
+
+void report(const char* name, int frames, double us) {
+    std::printf("%-48s %6d frames %10.1f us/frame\n", name, frames, us);
+}
+
+// sacct -P dump of `jobs` allocations, each followed by its batch and one step
+std::string syntheticSacct(int jobs) {
+    std::string out;
+    char line[512];
+    for (int i = 0; i < jobs; ++i) {
+        int id = 1000000 + i;
+        std::snprintf(line, sizeof(line),
+                      "%d|sweep_%d|COMPLETED|2026-10-01T10:%02d:00|2026-10-01T11:%02d:00|01:00:00|0:0||04:00:00|4|1|"
+                      "cpu|proj%d|03:12:00|16G|02:00:00\n"
+                      "%d.batch|batch|COMPLETED|2026-10-01T10:%02d:00|2026-10-01T11:%02d:00|01:00:00|0:0|%dK|04:00:00|"
+                      "4|1|||03:10:00||\n"
+                      "%d.0|solver|COMPLETED|2026-10-01T10:%02d:00|2026-10-01T11:%02d:00|00:59:00|0:0|%dM|03:56:00|"
+                      "4|1|||03:09:00||\n",
+                      id, i % 50, i % 60, i % 60, i % 8, id, i % 60, i % 60, 1000 + i % 5000, id, i % 60, i % 60,
+                      100 + i % 9000);
+        out += line;
+    }
+    return out;
+}
+
+// squeue dump in the job list format
+std::string syntheticSqueue(int jobs) {
+    std::string out;
+    char line[192];
+    for (int i = 0; i < jobs; ++i) {
+        bool running = i % 3 != 0;
+        char nodes[32] = "";
+        if (running) std::snprintf(nodes, sizeof(nodes), "romeo-a[%03d-%03d]", i % 500, i % 500 + i % 2);
+        std::snprintf(line, sizeof(line),
+                      "%d_%d|%s|%d|%d|cpu=%d,mem=%dG,node=%d,billing=%d,gres/gpu=%d|user%d|proj%d|%s|%s|train_%d\n",
+                      2000000 + i / 100, i % 100, running ? "RUNNING" : "PENDING", 4 << (i % 4), 1 + i % 2,
+                      4 << (i % 4), 8 << (i % 3), 1 + i % 2, 4 << (i % 4), i % 5, i % 800, i % 60,
+                      i % 4 ? "short" : "gpu", nodes, i % 37);
+        out += line;
+    }
+    return out;
+}
+
+// Parse throughput in MB/s, best of a few runs
+template <typename F>
+void reportThroughput(const char* name, const std::string& data, F&& parse) {
+    double best = 1e30;
+    size_t rows = 0;
+    for (int run = 0; run < 3; ++run) {
+        auto start = BenchClock::now();
+        rows = parse();
+        best = std::min(best, std::chrono::duration<double>(BenchClock::now() - start).count());
+    }
+    std::printf("%-48s %9zu rows %10.1f MB/s\n", name, rows, (double)data.size() / (1 << 20) / best);
+}
+
+}
+
+// Milliseconds per call of f(), best of a few runs
+template <typename F>
+void reportMs(const char* name, F&& f) {
+    double best = 1e30;
+    size_t result = 0;
+    for (int run = 0; run < 3; ++run) {
+        auto start = BenchClock::now();
+        result = f();
+        best = std::min(best, std::chrono::duration<double, std::milli>(BenchClock::now() - start).count());
+    }
+    std::printf("%-48s %9zu      %10.3f ms\n", name, result, best);
+}
+
+int main() {
+    const int width = 200, height = 60, frames = 50;
+    auto screen = Screen::Create(Dimension::Fixed(width), Dimension::Fixed(height));
+
+    auto scrolled = [](Element e, int i) {
+        return e | focusPositionRelative(0.f, (i % 20) / 20.f) | frame;
+    };
+
+    for (int nodes : {64, 1024}) {
+        auto job = syntheticJob(nodes, 128, 4);
+        ui::NodeGridView view;
+        auto scroll_view = [&](int i) { view.scrollTo(view.content * (i % 20) / 20); };
+
+        std::printf("Node grid: %d nodes x 128 cores, %dx%d screen\n", nodes, width, height);
+
+        report("element per core (build + layout + draw)", frames, perFrameUs(frames, [&](int i) {
+            Render(screen, scrolled(legacy::nodeGrid(job, width), i));
+        }));
+        report("NodeGrid (build + layout + draw)", frames, perFrameUs(frames, [&](int i) {
+            scroll_view(i);
+            Render(screen, ui::nodeGrid(job, &view));
+        }));
+
+        auto legacy_tree = legacy::nodeGrid(job, width);
+        report("element per core, memoized (scroll only)", frames, perFrameUs(frames, [&](int i) {
+            Render(screen, scrolled(legacy_tree, i));
+        }));
+        auto grid = ui::nodeGrid(job, &view);
+        report("NodeGrid, memoized (scroll only)", frames, perFrameUs(frames, [&](int i) {
+            scroll_view(i);
+            Render(screen, grid);
+        }));
+        std::printf("\n");
+    }
+
+    // Parsers of large sacct/squeue dumps, one thread against every core
+    size_t threads = api::parse::defaultThreads();
+    std::string sacct = syntheticSacct(400000);
+    std::string squeue = syntheticSqueue(2000000);
+    std::printf("Parsing: sacct %.0f MB, squeue %.0f MB, %zu threads\n", (double)sacct.size() / (1 << 20),
+                (double)squeue.size() / (1 << 20), threads);
+    reportThroughput("sacct, 1 thread", sacct, [&] { return api::history::parseSacct(sacct, 1).size(); });
+    reportThroughput("sacct, parallel chunks", sacct, [&] { return api::history::parseSacct(sacct, threads).size(); });
+    reportThroughput("squeue, 1 thread", squeue, [&] { return api::slurm::parseJobs(squeue, 1).size(); });
+    reportThroughput("squeue, parallel chunks", squeue,
+                     [&] { return api::slurm::parseJobs(squeue, threads).size(); });
+
+    // Whole-cluster queue (--all): full load, then a refresh where 1% of the jobs changed
+    std::printf("\nJob table: 100k jobs\n");
+    auto queue = api::slurm::parseJobs(syntheticSqueue(100000));
+    api::JobTable table;
+    reportMs("first load (index every job)", [&] { return api::JobTable().update(queue); });
+    table.update(queue);
+    reportMs("two refreshes, 1% changed each", [&] {
+        auto next = queue;
+        for (size_t i = 0; i < next.size(); i += 100) next[i].state = next[i].state == "PENDING" ? "RUNNING" : "PENDING";
+        table.update(next);
+        return table.update(queue);
+    });
+    reportMs("filter user + state", [&] {
+        return table.select(api::JobTable::parseFilter("user:user42 state:running")).size();
+    });
+    reportMs("count per state", [&] { return table.groups(api::JobTable::State).size(); });
+    reportMs("jobs on a node", [&] { return table.count(api::JobTable::Node, "romeo-a042"); });
+
+    return 0;
+}
@@ -59,6 +59,15 @@ do_run() {
     ./rsv
 }
 
+do_bench() {
+    print_step "Benchmarks"
+    mkdir -p "$BUILD_DIR"
+    cd "$BUILD_DIR"
+    cmake -DBUILD_BENCH=ON ..
+    cmake --build . --target rsv_bench -j$(nproc 2>/dev/null || echo 4)
+    ./rsv_bench
+}
+
 show_help() {
     echo -e "${YELLOW}RSV - Script de développement${NC}"
     echo ""
@@ -69,6 +78,7 @@ show_help() {
     echo "  configure Configure CMake (télécharge FTXUI si nécessaire)"
     echo "  build     Compile le projet (configure si nécessaire)"
     echo "  run       Lance l'application"
+    echo "  bench     Compile et lance les micro-benchmarks (rsv_bench)"
     echo "  all       Clean + Build + affiche la commande pour lancer"
     echo "  help      Affiche cette aide"
     echo ""
@@ -88,6 +98,9 @@ case "${1:-}" in
     run)
         do_run
         ;;
+    bench)
+        do_bench
+        ;;
     all)
         do_clean
         do_build
@@ -0,0 +1,197 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace api {
+
+// Case-insensitive multi-pattern matcher compiled to a dense DFA over bytes:
+// one table lookup per input byte whatever the number of patterns. Each
+// pattern carries a tag bit; a scan reports the OR of the tags found.
+// Patterns flagged whole_word only match between non-word characters.
+class AhoCorasick {
+public:
+    // Scan state carried across blocks of a stream
+    struct Cursor {
+        uint32_t state = 0;
+        uint32_t tags = 0;         // Tags found in the current line so far
+        uint32_t pending = 0;      // Whole-word matches waiting for the next byte
+        uint64_t word_bits = 0;    // Bit i: byte i positions back was a word char
+    };
+
+    static constexpr size_t MAX_PATTERN = 63;
+    static constexpr size_t MAX_STATES = 65536;
+
+    void add(std::string_view pattern, uint32_t tag, bool whole_word = false) {
+        if (pattern.empty() || pattern.size() > MAX_PATTERN) return;
+        if (nodes_.size() + pattern.size() > MAX_STATES) return;
+        if (nodes_.empty()) nodes_.emplace_back();
+        uint32_t s = 0;
+        for (unsigned char c : pattern) {
+            uint8_t f = fold(c);
+            if (nodes_[s].next[f] == 0) {
+                nodes_[s].next[f] = (uint32_t)nodes_.size();
+                nodes_.emplace_back();
+            }
+            s = nodes_[s].next[f];
+        }
+        if (whole_word) nodes_[s].bounded.push_back({(uint8_t)pattern.size(), tag});
+        else nodes_[s].tags |= tag;
+    }
+
+    // Compute failure transitions; must be called after the last add()
+    void build() {
+        if (nodes_.empty()) nodes_.emplace_back();
+        size_t n = nodes_.size();
+        delta_.assign(n * 256, 0);
+        tags_.assign(n, 0);
+        bounded_.assign(n, {});
+        hit_.assign(n, 0);
+
+        std::vector<uint32_t> fail(n, 0);
+        std::deque<uint32_t> queue;
+        for (int c = 0; c < 256; ++c) {
+            uint32_t child = nodes_[0].next[c];
+            delta_[c] = child;
+            if (child) queue.push_back(child);
+        }
+        tags_[0] = nodes_[0].tags;
+
+        while (!queue.empty()) {
+            uint32_t s = queue.front();
+            queue.pop_front();
+            tags_[s] = nodes_[s].tags | tags_[fail[s]];
+            bounded_[s] = nodes_[s].bounded;
+            bounded_[s].insert(bounded_[s].end(), bounded_[fail[s]].begin(), bounded_[fail[s]].end());
+
+            hit_[s] = tags_[s] != 0 || !bounded_[s].empty();
+
+            for (int c = 0; c < 256; ++c) {
+                uint32_t child = nodes_[s].next[c];
+                if (child) {
+                    fail[child] = delta_[fail[s] * 256 + c];
+                    delta_[s * 256 + c] = child;
+                    queue.push_back(child);
+                } else {
+                    delta_[s * 256 + c] = delta_[fail[s] * 256 + c];
+                }
+            }
+        }
+
+        // Transitions on raw bytes: upper case goes where its lower case goes
+        for (size_t s = 0; s < n; ++s)
+            for (int c = 'A'; c <= 'Z'; ++c) delta_[s * 256 + c] = delta_[s * 256 + c + 32];
+
+        // Renumber so states with an output come last: the scan loop tests
+        // `s >= first_hit_` instead of loading a flag. Root stays 0.
+        std::vector<uint32_t> order, rename(n);
+        for (size_t s = 0; s < n; ++s) if (!hit_[s]) order.push_back((uint32_t)s);
+        first_hit_ = (uint32_t)order.size();
+        for (size_t s = 0; s < n; ++s) if (hit_[s]) order.push_back((uint32_t)s);
+        for (size_t i = 0; i < n; ++i) rename[order[i]] = (uint32_t)i;
+
+        table_.assign(n * 256, 0);
+        std::vector<uint32_t> tags(n);
+        std::vector<std::vector<Bounded>> bounded(n);
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t old = order[i];
+            for (int c = 0; c < 256; ++c) table_[i * 256 + c] = (uint16_t)rename[delta_[old * 256 + c]];
+            tags[i] = tags_[old];
+            bounded[i] = std::move(bounded_[old]);
+        }
+        tags_ = std::move(tags);
+        bounded_ = std::move(bounded);
+        delta_.clear();
+        delta_.shrink_to_fit();
+        hit_.clear();
+    }
+
+    bool empty() const { return nodes_.size() <= 1; }
+
+    // Feed a block of a stream; on_line(pos, tags) at every '\n' (pos in the block)
+    template <typename F>
+    void feed(Cursor& cur, const char* data, size_t n, F&& on_line) const {
+        static const auto word_table = [] {
+            std::array<uint8_t, 256> t{};
+            for (int c = 0; c < 256; ++c) t[c] = isWord((unsigned char)c);
+            return t;
+        }();
+
+        const uint16_t* delta = table_.data();
+        const uint32_t first_hit = first_hit_;
+        uint32_t s = cur.state;
+        uint32_t tags = cur.tags;
+        uint32_t pending = cur.pending;
+        uint64_t word_bits = cur.word_bits;
+
+        for (size_t i = 0; i < n; ++i) {
+            unsigned char c = (unsigned char)data[i];
+            uint64_t word = word_table[c];
+            if (pending) {
+                if (!word) tags |= pending;
+                pending = 0;
+            }
+
+            if (c == '\n') {
+                on_line(i, tags);
+                s = 0;
+                tags = 0;
+                word_bits = 0;
+                continue;
+            }
+
+            word_bits = (word_bits << 1) | word;
+            s = delta[s * 256 + c];
+            if (s >= first_hit) {
+                tags |= tags_[s];
+                for (const auto& b : bounded_[s]) {
+                    // Byte before the match must not be a word char
+                    if (!((word_bits >> b.length) & 1)) pending |= b.tag;
+                }
+            }
+        }
+
+        cur.state = s;
+        cur.tags = tags;
+        cur.pending = pending;
+        cur.word_bits = word_bits;
+    }
+
+    // Tags found in a single line
+    uint32_t scan(std::string_view line) const {
+        Cursor cur;
+        feed(cur, line.data(), line.size(), [](size_t, uint32_t) {});
+        return cur.tags | cur.pending;  // End of line closes a whole-word match
+    }
+
+private:
+    struct Bounded {
+        uint8_t length;
+        uint32_t tag;
+    };
+
+    struct TrieNode {
+        std::array<uint32_t, 256> next{};
+        uint32_t tags = 0;
+        std::vector<Bounded> bounded;
+    };
+
+    static uint8_t fold(unsigned char c) { return (c >= 'A' && c <= 'Z') ? (uint8_t)(c + 32) : c; }
+
+    static bool isWord(unsigned char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    std::vector<TrieNode> nodes_;
+    std::vector<uint32_t> delta_;                 // Build only: states x 256
+    std::vector<uint16_t> table_;                 // Scan: states x 256, raw bytes
+    uint32_t first_hit_ = 0;
+    std::vector<uint32_t> tags_;                  // Tags ending at a state, failure chain included
+    std::vector<std::vector<Bounded>> bounded_;   // Whole-word patterns ending at a state
+    std::vector<uint8_t> hit_;                    // Build only: state has an output
+};
+
+}
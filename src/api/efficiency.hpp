@@ -0,0 +1,241 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "history_table.hpp"
+
+namespace api {
+
+// How well finished jobs used what they asked for, and what they should ask
+// for next time, per job name or partition. Requests are given the way sbatch
+// takes them: --mem per node and -c per task. sacct reports the CPU time of
+// the whole job and the memory of its largest task, so both are brought to
+// that scale with the task and node counts of each job.
+struct EfficiencyGroup {
+    std::string key;  // Job name or partition
+    int jobs = 0;
+    int completed = 0;
+    int out_of_memory = 0;
+    int timeouts = 0;
+
+    // Means over the jobs where both sides are known; -1 when none is
+    float cpu_eff = -1;   // TotalCPU / (Elapsed × NCPUs)
+    float mem_eff = -1;   // MaxRSS × tasks per node / ReqMem per node
+    float time_use = -1;  // Elapsed / Timelimit
+
+    // Request of the latest job, per node and per task; -1 when unknown
+    int64_t req_mem = -1;
+    int32_t req_cpus = -1;
+    int64_t req_time = -1;
+    // Its layout, which the recommendation keeps
+    int32_t tasks = -1;
+    int32_t nodes = -1;
+
+    // Recommendation (--mem per node, -c per task); -1 when there is not enough to go on
+    int64_t mem = -1;
+    int32_t cpus = -1;
+    int64_t time = -1;
+};
+
+// Per-job ratios laid out like NodeTable: the rows of each group are
+// contiguous, and unknown ratios are stored as 0 with a 0 weight, so the
+// per-group means are branchless loops the compiler can vectorize
+struct EfficiencyTable {
+    static constexpr float MEM_MARGIN = 1.2f;   // Over the p95 of MaxRSS
+    static constexpr double CPU_SLACK = 0.05;   // Cores used above a whole count, as noise
+    static constexpr float TIME_MARGIN = 1.3f;  // Over the p95 of Elapsed
+    static constexpr int64_t TIME_STEP = 15 * 60;
+    static constexpr double PERCENTILE = 0.95;
+
+    std::vector<uint32_t> rows;  // Rows of the history table, grouped
+    std::vector<float> cpu_eff, cpu_weight;
+    std::vector<float> mem_eff, mem_weight;
+    std::vector<float> time_use, time_weight;
+    std::vector<EfficiencyGroup> groups;
+    std::vector<uint32_t> group_begin;  // groups + 1 offsets into the rows
+
+    EfficiencyTable() = default;
+
+    // Jobs of `table` finished since `since` (epoch seconds), grouped by Name or Partition
+    EfficiencyTable(const HistoryTable& table, HistoryTable::Column by, int64_t since = 0) {
+        if (by != HistoryTable::Partition) by = HistoryTable::Name;
+        const auto& keys = by == HistoryTable::Partition ? table.partition : table.name;
+        // Sorted by key then id: groups come out contiguous, latest job last
+        for (uint32_t row : table.order(by)) {
+            JobState s = table.state[row];
+            if (s == JobState::Pending || s == JobState::Running || table.elapsed[row] <= 0) continue;
+            if (table.end[row] != 0 && table.end[row] < since) continue;
+            if (groups.empty() || keys[row] != groups.back().key) {
+                group_begin.push_back((uint32_t)rows.size());
+                groups.emplace_back();
+                groups.back().key = keys[row];
+            }
+            rows.push_back(row);
+        }
+        group_begin.push_back((uint32_t)rows.size());
+
+        size_t n = rows.size();
+        for (auto* column : {&cpu_eff, &cpu_weight, &mem_eff, &mem_weight, &time_use, &time_weight}) column->resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t row = rows[i];
+            double elapsed = (double)table.elapsed[row];
+            if (table.total_cpu[row] >= 0 && table.ncpus[row] > 0) {
+                cpu_eff[i] = (float)(table.total_cpu[row] / (elapsed * table.ncpus[row]));
+                cpu_weight[i] = 1;
+            }
+            if (table.max_rss[row] >= 0 && table.req_mem[row] > 0) {
+                mem_eff[i] = (float)((double)nodeMemory(table, row) / (double)nodeRequest(table, row));
+                mem_weight[i] = 1;
+            }
+            if (table.time_limit[row] > 0) {
+                time_use[i] = (float)(elapsed / (double)table.time_limit[row]);
+                time_weight[i] = 1;
+            }
+        }
+
+        for (size_t g = 0; g < groups.size(); ++g) summarize(table, g);
+    }
+
+    size_t size() const { return groups.size(); }
+
+    // Tasks of a job; one per node when sacct counted none
+    static int32_t tasks(const HistoryTable& t, uint32_t row) {
+        return t.ntasks[row] > 0 ? t.ntasks[row] : nodes(t, row);
+    }
+    static int32_t nodes(const HistoryTable& t, uint32_t row) { return std::max(t.nnodes[row], 1); }
+
+    // Peak memory of the busiest node: the largest task times the tasks it shares the node with
+    static int64_t nodeMemory(const HistoryTable& t, uint32_t row) {
+        int32_t per_node = (tasks(t, row) + nodes(t, row) - 1) / nodes(t, row);
+        return t.max_rss[row] * per_node;
+    }
+    static int64_t nodeRequest(const HistoryTable& t, uint32_t row) { return t.req_mem[row] / nodes(t, row); }
+
+    // Weighted mean of values[begin, end); -1 when every weight is 0. Sums
+    // are kept in LANES independent accumulators: without -ffast-math the
+    // compiler may not reorder one float sum, but it vectorizes these.
+    static constexpr size_t LANES = 8;
+    static float mean(const std::vector<float>& values, const std::vector<float>& weights, size_t begin, size_t end) {
+        const float* __restrict v = values.data();
+        const float* __restrict w = weights.data();
+        float sum[LANES] = {}, count[LANES] = {};
+        size_t i = begin;
+        for (; i + LANES <= end; i += LANES) {
+            for (size_t k = 0; k < LANES; ++k) {
+                sum[k] += v[i + k] * w[i + k];
+                count[k] += w[i + k];
+            }
+        }
+        for (; i < end; ++i) {
+            sum[0] += v[i] * w[i];
+            count[0] += w[i];
+        }
+        float total = 0, weight = 0;
+        for (size_t k = 0; k < LANES; ++k) {
+            total += sum[k];
+            weight += count[k];
+        }
+        return weight > 0 ? total / weight : -1;
+    }
+
+    // p-th percentile, partially reordering `values`; -1 when empty
+    static double percentile(std::vector<double>& values, double p) {
+        if (values.empty()) return -1;
+        size_t k = (size_t)std::ceil(p * (double)values.size()) - 1;
+        k = std::min(k, values.size() - 1);
+        std::nth_element(values.begin(), values.begin() + (ptrdiff_t)k, values.end());
+        return values[k];
+    }
+
+private:
+    void summarize(const HistoryTable& t, size_t g) {
+        auto& s = groups[g];
+        size_t begin = group_begin[g], end = group_begin[g + 1];
+        s.jobs = (int)(end - begin);
+        s.cpu_eff = mean(cpu_eff, cpu_weight, begin, end);
+        s.mem_eff = mean(mem_eff, mem_weight, begin, end);
+        s.time_use = mean(time_use, time_weight, begin, end);
+
+        uint32_t latest = rows[end - 1];
+        s.tasks = tasks(t, latest);
+        s.nodes = nodes(t, latest);
+        s.req_mem = t.req_mem[latest] > 0 ? nodeRequest(t, latest) : -1;
+        s.req_cpus = t.ncpus[latest] > 0 ? (t.ncpus[latest] + s.tasks - 1) / s.tasks : -1;
+        s.req_time = t.time_limit[latest];
+
+        // Sized on the jobs that ran to completion; jobs killed for memory or
+        // time show their request was too small
+        std::vector<double> rss, cores, elapsed;
+        int64_t oom_request = -1, timeout_limit = -1;
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t row = rows[i];
+            switch (t.state[row]) {
+                case JobState::Completed:
+                    s.completed++;
+                    if (t.max_rss[row] >= 0) rss.push_back((double)nodeMemory(t, row));
+                    if (t.total_cpu[row] >= 0)
+                        cores.push_back((double)t.total_cpu[row] / (double)t.elapsed[row] / tasks(t, row));
+                    elapsed.push_back((double)t.elapsed[row]);
+                    break;
+                case JobState::OutOfMemory:
+                    s.out_of_memory++;
+                    if (t.req_mem[row] > 0) oom_request = std::max(oom_request, nodeRequest(t, row));
+                    break;
+                case JobState::Timeout:
+                    s.timeouts++;
+                    timeout_limit = std::max(timeout_limit, t.time_limit[row]);
+                    break;
+                default: break;
+            }
+        }
+
+        double p_rss = percentile(rss, PERCENTILE);
+        if (p_rss >= 0) s.mem = roundMemory((int64_t)(p_rss * MEM_MARGIN));
+        if (oom_request > 0) s.mem = std::max(s.mem, roundMemory(oom_request * 3 / 2));
+
+        double p_cores = percentile(cores, PERCENTILE);
+        if (p_cores >= 0) s.cpus = std::max<int32_t>(1, (int32_t)std::ceil(p_cores - CPU_SLACK));
+
+        double p_elapsed = percentile(elapsed, PERCENTILE);
+        if (p_elapsed >= 0) s.time = roundTime((int64_t)(p_elapsed * TIME_MARGIN));
+        if (timeout_limit > 0) s.time = std::max(s.time, roundTime(timeout_limit * 3 / 2));
+    }
+
+    // Up to the next 256M below 4G, the next G above
+    static int64_t roundMemory(int64_t bytes) {
+        const int64_t mb = 1024 * 1024, gb = 1024 * mb;
+        int64_t step = bytes < 4 * gb ? 256 * mb : gb;
+        return std::max(step, (bytes + step - 1) / step * step);
+    }
+
+    static int64_t roundTime(int64_t seconds) {
+        return std::max(TIME_STEP, (seconds + TIME_STEP - 1) / TIME_STEP * TIME_STEP);
+    }
+};
+
+namespace history {
+
+// Values as sbatch takes them: "--mem=12G", "-c 4", "--time=1-02:00:00"
+inline std::string slurmMemory(int64_t bytes) {
+    if (bytes < 0) return "-";
+    const int64_t mb = 1024 * 1024, gb = 1024 * mb;
+    if (bytes % gb == 0) return std::to_string(bytes / gb) + "G";
+    return std::to_string((bytes + mb - 1) / mb) + "M";
+}
+
+inline std::string slurmTime(int64_t seconds) {
+    if (seconds < 0) return "UNLIMITED";
+    char buf[32];
+    int64_t days = seconds / 86400;
+    int h = (int)(seconds / 3600 % 24), m = (int)(seconds / 60 % 60), s = (int)(seconds % 60);
+    if (days > 0) std::snprintf(buf, sizeof(buf), "%lld-%02d:%02d:%02d", (long long)days, h, m, s);
+    else std::snprintf(buf, sizeof(buf), "%02d:%02d:%02d", h, m, s);
+    return buf;
+}
+
+}
+
+}
@@ -0,0 +1,211 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "parallel_parse.hpp"
+
+namespace api {
+
+// One job of the sacct history (allocation line, steps excluded)
+struct HistoryJob {
+    std::string id;
+    std::string name;
+    std::string state;
+    std::string start;
+    std::string end;
+    std::string elapsed;
+    std::string exit_code;
+    std::string max_rss;      // Peak memory usage
+    std::string cpu_time;     // Total CPU time
+    std::string ncpus;        // Number of CPUs
+    std::string nnodes;       // Number of nodes
+    std::string partition;
+    std::string account;
+    std::string total_cpu;    // CPU time actually used (user + system)
+    std::string req_mem;      // "16G", or per node/CPU on older Slurm ("4000Mn", "2000Mc")
+    std::string time_limit;   // "1-00:00:00", "UNLIMITED"
+    std::string ntasks;       // Tasks of the largest step
+
+    // Fields in sacct --format order
+    static constexpr size_t FIELDS = 17;
+    static constexpr std::string HistoryJob::*MEMBERS[FIELDS] = {
+        &HistoryJob::id, &HistoryJob::name, &HistoryJob::state, &HistoryJob::start, &HistoryJob::end,
+        &HistoryJob::elapsed, &HistoryJob::exit_code, &HistoryJob::max_rss, &HistoryJob::cpu_time,
+        &HistoryJob::ncpus, &HistoryJob::nnodes, &HistoryJob::partition, &HistoryJob::account,
+        &HistoryJob::total_cpu, &HistoryJob::req_mem, &HistoryJob::time_limit, &HistoryJob::ntasks,
+    };
+
+    std::string& field(size_t i) { return this->*MEMBERS[i]; }
+    const std::string& field(size_t i) const { return this->*MEMBERS[i]; }
+
+    bool operator==(const HistoryJob& o) const {
+        for (size_t i = 0; i < FIELDS; ++i)
+            if (field(i) != o.field(i)) return false;
+        return true;
+    }
+};
+
+namespace history {
+
+constexpr const char* SACCT_FORMAT =
+    "JobID,JobName%30,State,Start,End,Elapsed,ExitCode,MaxRSS,CPUTime,NCPUs,NNodes,Partition,Account,"
+    "TotalCPU,ReqMem,Timelimit,NTasks";
+
+// "1234K", "512M", "2.5G" (powers of 1024; plain numbers are bytes); -1 when unknown
+inline int64_t parseMemory(const std::string& s) {
+    if (s.empty() || !std::isdigit((unsigned char)s[0])) return -1;
+    char* end;
+    double value = std::strtod(s.c_str(), &end);
+    double scale = 1;
+    switch (*end) {
+        case 'K': case 'k': scale = 1024.0; break;
+        case 'M': case 'm': scale = 1024.0 * 1024; break;
+        case 'G': case 'g': scale = 1024.0 * 1024 * 1024; break;
+        case 'T': case 't': scale = 1024.0 * 1024 * 1024 * 1024; break;
+    }
+    return (int64_t)(value * scale);
+}
+
+// sacct -P rows of the allocations, fed one line at a time. MaxRSS and
+// NTasks are only reported on steps (12345.batch, 12345.0), which sacct
+// prints right after their job: the largest of each is kept on the job.
+class SacctParser {
+public:
+    void feed(std::string_view line) {
+        if (line.empty()) return;
+        parse::splitFields(line, '|', fields_);
+        if (fields_.size() < 7) return;
+
+        size_t dot = fields_[0].find('.');
+        if (dot != std::string_view::npos) {
+            if (jobs_.empty() || fields_.size() <= 7 || fields_[0].substr(0, dot) != jobs_.back().id) return;
+            HistoryJob& job = jobs_.back();
+            std::string step_rss(fields_[7]);
+            if (parseMemory(step_rss) > parseMemory(job.max_rss)) job.max_rss = std::move(step_rss);
+            constexpr size_t NTASKS = HistoryJob::FIELDS - 1;
+            if (fields_.size() > NTASKS) {
+                std::string step_tasks(fields_[NTASKS]);
+                if (std::atoi(step_tasks.c_str()) > std::atoi(job.ntasks.c_str())) job.ntasks = std::move(step_tasks);
+            }
+            return;
+        }
+
+        HistoryJob& job = jobs_.emplace_back();
+        for (size_t i = 0; i < std::min(fields_.size(), HistoryJob::FIELDS); ++i) job.field(i).assign(fields_[i]);
+    }
+
+    std::vector<HistoryJob>& jobs() { return jobs_; }
+
+private:
+    std::vector<HistoryJob> jobs_;
+    std::vector<std::string_view> fields_;
+};
+
+// A job line, as opposed to one of its steps: chunks of a dump start there
+inline bool jobLine(std::string_view line) {
+    size_t bar = line.find('|');
+    return line.substr(0, bar).find('.') == std::string_view::npos;
+}
+
+// Large outputs are parsed on every core, chunks cut between jobs
+inline std::vector<HistoryJob> parseSacct(std::string_view out, size_t threads = 0) {
+    return parse::parallel<HistoryJob>(
+        out,
+        [](std::string_view chunk, std::vector<HistoryJob>& jobs) {
+            SacctParser parser;
+            parser.jobs().swap(jobs);
+            parse::forEachLine(chunk, [&](std::string_view line) { parser.feed(line); });
+            parser.jobs().swap(jobs);
+        },
+        jobLine, threads);
+}
+
+// Start of the last job line of `out` (0 when there is none past the first
+// line): what precedes it is complete, steps included
+inline size_t lastJobStart(std::string_view out) {
+    size_t end = out.size();
+    while (end > 0) {
+        size_t nl = out.rfind('\n', end - 1);
+        if (nl == std::string_view::npos) return 0;
+        size_t start = nl + 1;
+        if (start < out.size() && jobLine(out.substr(start, out.find('\n', start) - start))) return start;
+        end = nl;
+    }
+    return 0;
+}
+
+// sacct timestamp ("2026-10-18T09:12:44", local time); 0 for Unknown/None.
+// mktime() runs once per hour of the calendar seen in a row, not per call.
+inline int64_t parseTime(const std::string& s) {
+    if (s.size() < 19 || s[4] != '-' || s[7] != '-' || s[10] != 'T' || s[13] != ':' || s[16] != ':') return 0;
+    auto number = [&](size_t pos, size_t len) {
+        int value = 0;
+        for (size_t i = pos; i < pos + len; ++i) {
+            if (s[i] < '0' || s[i] > '9') return -1;
+            value = value * 10 + (s[i] - '0');
+        }
+        return value;
+    };
+    std::tm tm{};
+    tm.tm_year = number(0, 4);
+    tm.tm_mon = number(5, 2);
+    tm.tm_mday = number(8, 2);
+    tm.tm_hour = number(11, 2);
+    tm.tm_min = number(14, 2);
+    tm.tm_sec = number(17, 2);
+    if (std::min({tm.tm_year, tm.tm_mon, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec}) < 0) return 0;
+    int64_t seconds = tm.tm_min * 60 + tm.tm_sec;
+    int64_t hour = ((int64_t)tm.tm_year * 100 + tm.tm_mon) * 10000 + tm.tm_mday * 100 + tm.tm_hour;
+    thread_local std::unordered_map<int64_t, int64_t> hour_start;
+    auto it = hour_start.find(hour);
+    if (it == hour_start.end()) {
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+        tm.tm_min = tm.tm_sec = 0;
+        tm.tm_isdst = -1;
+        if (hour_start.size() > 100000) hour_start.clear();
+        it = hour_start.emplace(hour, (int64_t)mktime(&tm)).first;
+    }
+    return it->second + seconds;
+}
+
+inline std::string formatTime(int64_t t) {
+    std::time_t time = (std::time_t)t;
+    std::tm tm{};
+    localtime_r(&time, &tm);
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+    return buf;
+}
+
+// States after which sacct never changes the record
+inline bool terminal(const std::string& state) {
+    for (const char* s : {"PENDING", "RUNNING", "REQUEUED", "RESIZING", "SUSPENDED", "COMPLETING", "CONFIGURING",
+                          "STAGE_OUT", "REQUEUE_", "SIGNALING"}) {
+        if (state.compare(0, strlen(s), s) == 0) return false;
+    }
+    return true;
+}
+
+// Newest first: higher job id, then higher task id
+inline bool newer(const HistoryJob& a, const HistoryJob& b) {
+    long long ia = std::atoll(a.id.c_str()), ib = std::atoll(b.id.c_str());
+    if (ia != ib) return ia > ib;
+    size_t ua = a.id.find('_'), ub = b.id.find('_');
+    long long ta = ua == std::string::npos ? -1 : std::atoll(a.id.c_str() + ua + 1);
+    long long tb = ub == std::string::npos ? -1 : std::atoll(b.id.c_str() + ub + 1);
+    if (ta != tb) return ta > tb;
+    return a.id > b.id;
+}
+
+}
+
+}
@@ -0,0 +1,601 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "history_job.hpp"
+#include "history_table.hpp"
+#include "log_file.hpp"
+#include "parallel_parse.hpp"
+
+namespace api {
+
+namespace history {
+
+// Output of `cmd` as it is read, without holding all of it. Returns
+// whether the command ran and exited with status 0: a failed query (sacct
+// timing out on slurmdbd) must not be taken for an empty answer. Once
+// `cancel` is set the command is killed (with its children: it runs in its
+// own process group) and false is returned.
+template <typename F>
+inline bool stream(const std::string& cmd, F&& on_data, const std::atomic<bool>* cancel = nullptr) {
+    constexpr int CANCEL_POLL_MS = 100;
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) return false;
+    pid_t pid = fork();
+    if (pid < 0) {
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        setpgid(0, 0);
+        dup2(fds[1], STDOUT_FILENO);
+        execl("/bin/sh", "sh", "-c", cmd.c_str(), (char*)nullptr);
+        _exit(127);
+    }
+    setpgid(pid, pid);  // Also here: kill() may come before the child ran
+    ::close(fds[1]);
+
+    std::array<char, 1 << 16> buffer;
+    bool killed = false;
+    while (true) {
+        if (cancel && *cancel) {
+            kill(-pid, SIGTERM);
+            killed = true;
+            break;
+        }
+        pollfd p{fds[0], POLLIN, 0};
+        int ready = ::poll(&p, 1, CANCEL_POLL_MS);
+        if (ready == 0 || (ready < 0 && errno == EINTR)) continue;
+        if (ready < 0) break;
+        ssize_t n = ::read(fds[0], buffer.data(), buffer.size());
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        on_data(buffer.data(), (size_t)n);
+    }
+    ::close(fds[0]);
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    return !killed && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+inline std::string run(const std::string& cmd) {
+    std::array<char, 4096> buffer;
+    std::string result;
+    std::unique_ptr<FILE, int(*)(FILE*)> pipe(popen(cmd.c_str(), "r"), static_cast<int(*)(FILE*)>(pclose));
+    if (!pipe) return result;
+    size_t n;
+    while ((n = fread(buffer.data(), 1, buffer.size(), pipe.get())) > 0) result.append(buffer.data(), n);
+    return result;
+}
+
+}
+
+// The user's sacct history kept on local disk (~/.cache/rsv), so the view
+// opens at once and slurmdbd is only asked for what changed. The file is an
+// append-only log of job records and sync markers: a newer record of a job
+// replaces the older one on load, and the file is rewritten once most of it
+// is superseded. A sync asks sacct for the jobs active since the last sync
+// (a few minutes of overlap), for jobs still pending or running in the store
+// that it did not return, and once for any part of a wider window not fetched
+// before. Long ranges are cut into time slices fetched by a few concurrent
+// sacct processes, newest first; their output is parsed as it streams in and
+// stored and published in batches, so the first page shows up while a year
+// of history is still loading and no whole sacct output is ever held in
+// memory. Each publish builds a HistoryTable of every record on the thread
+// that stored them; views swap it in without copying or parsing anything.
+// Several rsv instances share the file under flock().
+class HistoryStore {
+public:
+    using Jobs = std::vector<HistoryJob>;
+
+    static constexpr int DEFAULT_DAYS = 7;
+    // Records ended longer ago than this are dropped when the file is rewritten
+    static constexpr int KEEP_DAYS = 400;
+    // Seconds fetched again before the last sync (accounting is written late)
+    static constexpr int64_t OVERLAP = 300;
+    // A sync younger than this is served as is
+    static constexpr int64_t FRESH = 60;
+    static constexpr size_t IDS_PER_QUERY = 200;
+    static constexpr int64_t SLICE = 7 * 86400;
+    // sacct processes running at once during a sync
+    static constexpr size_t MAX_QUERIES = 4;
+    // Output parsed at once before it is stored and shown (about 20k jobs)
+    static constexpr size_t BLOCK = 4 << 20;
+    static constexpr auto PUBLISH_INTERVAL = std::chrono::milliseconds(250);
+
+    static std::string defaultPath() {
+        const char* user = std::getenv("USER");
+        const char* xdg = std::getenv("XDG_CACHE_HOME");
+        const char* home = std::getenv("HOME");
+        std::string dir = xdg && *xdg ? xdg : std::string(home ? home : "/tmp") + "/.cache";
+        mkdir(dir.c_str(), 0755);
+        dir += "/rsv";
+        mkdir(dir.c_str(), 0700);
+        return dir + "/history-" + (user ? user : "unknown") + ".bin";
+    }
+
+    // Shared by every history view of the process
+    static HistoryStore& instance() {
+        static HistoryStore store(defaultPath());
+        created() = true;
+        return store;
+    }
+
+    // Stops the shared store, if it was ever used, before what its
+    // callbacks capture goes away (the screen, at the end of main)
+    static void shutdown() {
+        if (created()) instance().stop();
+    }
+
+    explicit HistoryStore(std::string path) : path_(std::move(path)) {
+        int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+        flock(fd, LOCK_SH);
+        readNew(fd);
+        flock(fd, LOCK_UN);
+        ::close(fd);
+        publish();
+    }
+
+    ~HistoryStore() { stop(); }
+
+    // Kills a running sync and waits for its thread: no callback runs after
+    // this returns, and no sync starts any more
+    void stop() {
+        stopped_ = true;
+        if (worker_.joinable()) worker_.join();
+    }
+
+    HistoryStore(const HistoryStore&) = delete;
+    HistoryStore& operator=(const HistoryStore&) = delete;
+
+    // Every stored job, newest first
+    std::shared_ptr<const HistoryTable> table() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return table_;
+    }
+
+    // Incremented whenever table() changes
+    uint64_t version() const { return version_; }
+    bool syncing() const { return busy_; }
+
+    int64_t lastSync() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return synced_at_;
+    }
+
+    // Time slices of the running sync, done and in total
+    size_t slicesDone() const { return slices_done_; }
+    size_t slicesTotal() const { return slices_total_; }
+
+    // Whether the last `days` were fetched at least once
+    bool covers(int days) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return covered_from_ != 0 && covered_from_ <= (int64_t)std::time(nullptr) - (int64_t)days * 86400;
+    }
+
+    // Fetch what changed in the background. A request made while a sync is
+    // running is queued (the widest window) and runs once right after it, so
+    // a window picked meanwhile is fetched without anyone polling for it.
+    // on_done runs on the worker thread whenever new jobs are visible, and
+    // once more at the end of each sync.
+    void syncAsync(int days = DEFAULT_DAYS, std::function<void()> on_done = {}) {
+        if (stopped_) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (busy_) {
+                queued_days_ = std::max(queued_days_, days);
+                queued_done_ = std::move(on_done);
+                return;
+            }
+            busy_ = true;
+        }
+        if (worker_.joinable()) worker_.join();
+
+        worker_ = std::thread([this, days, on_done = std::move(on_done)]() mutable {
+            while (true) {
+                sync(days, on_done);
+                std::function<void()> next_done;
+                bool again;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    again = queued_days_ != 0 && !stopped_;
+                    if (again) {
+                        days = queued_days_;
+                        next_done = std::move(queued_done_);
+                        queued_days_ = 0;
+                    } else {
+                        busy_ = false;
+                    }
+                }
+                if (on_done && !stopped_) on_done();
+                if (!again) return;
+                on_done = std::move(next_done);
+            }
+        });
+    }
+
+    void syncIfStale(int days = DEFAULT_DAYS, std::function<void()> on_done = {}) {
+        bool stale;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stale = std::time(nullptr) - synced_at_ >= FRESH;
+        }
+        if (stale || !covers(days)) syncAsync(days, std::move(on_done));
+    }
+
+private:
+    enum Entry : uint8_t { JOB = 1, SYNC = 2 };
+
+    static bool& created() {
+        static bool used = false;
+        return used;
+    }
+    // Bumped when the fields change: an older file is dropped and fetched again
+    static constexpr char MAGIC[8] = {'R', 'S', 'V', 'H', 'I', 'S', 'T', '3'};
+
+    void sync(int days, const std::function<void()>& on_progress) {
+        const char* user = std::getenv("USER");
+        std::string sacct = "sacct -u " + std::string(user ? user : "unknown") + " --format=" + history::SACCT_FORMAT +
+                            " --noheader -P";
+        int64_t now = (int64_t)std::time(nullptr);
+        int64_t window_start = now - (int64_t)days * 86400;
+
+        int64_t synced_at, covered_from;
+        std::set<std::string> active;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            synced_at = synced_at_;
+            covered_from = covered_from_;
+            for (const auto& [id, job] : records_)
+                if (!history::terminal(job->state)) active.insert(id);
+        }
+
+        // Changes since the last sync, or the whole window the first time,
+        // then the part of a wider window that was never fetched. The changes
+        // are fetched back to the last sync however old it is: the covered
+        // range must have no hole between covered_from and now.
+        bool incremental = synced_at > 0 && covered_from > 0;
+        int64_t since = incremental ? synced_at - OVERLAP : window_start;
+        std::vector<std::string> queries;
+        addSlices(queries, sacct, since, 0, now);
+        if (incremental && covered_from > window_start) addSlices(queries, sacct, window_start, covered_from, now);
+
+        std::mutex active_mutex;
+        std::atomic<bool> complete{true};  // Every query succeeded
+        auto fetch = [&](const std::string& cmd) {
+            std::string pending;
+            // Complete jobs of `pending`, up to `end`
+            auto flush = [&](size_t end) {
+                Jobs batch = history::parseSacct(std::string_view(pending).substr(0, end));
+                pending.erase(0, end);
+                if (batch.empty()) return;
+                {
+                    std::lock_guard<std::mutex> lock(active_mutex);
+                    for (const auto& job : batch) active.erase(job.id);
+                }
+                save(batch);
+                publish(false, on_progress);
+            };
+            bool ok = history::stream(cmd + " 2>/dev/null", [&](const char* data, size_t n) {
+                pending.append(data, n);
+                if (pending.size() >= BLOCK) flush(history::lastJobStart(pending));
+            }, &stopped_);
+            // Jobs before a failure are valid (the last one may be cut), but the range is not covered
+            flush(ok ? pending.size() : history::lastJobStart(pending));
+            if (!ok) complete = false;
+            slices_done_++;
+        };
+
+        slices_done_ = 0;
+        slices_total_ = queries.size();
+        std::atomic<size_t> next{0};
+        std::vector<std::thread> workers;
+        for (size_t w = 0; w < std::min(MAX_QUERIES, queries.size()); ++w) {
+            workers.emplace_back([&] {
+                for (size_t i; !stopped_ && (i = next++) < queries.size();) fetch(queries[i]);
+            });
+        }
+        for (auto& t : workers) t.join();
+
+        // Jobs last seen active that the window queries did not return
+        std::vector<std::string> ids(active.begin(), active.end());
+        slices_total_ += (ids.size() + IDS_PER_QUERY - 1) / IDS_PER_QUERY;
+        for (size_t i = 0; i < ids.size() && !stopped_; i += IDS_PER_QUERY) {
+            std::string list;
+            for (size_t j = i; j < std::min(ids.size(), i + IDS_PER_QUERY); ++j) list += (list.empty() ? "" : ",") + ids[j];
+            fetch(sacct + " -j " + list);
+        }
+
+        // A failed (or skipped) query leaves the marker as it was, so the next sync asks again
+        if (complete && !stopped_) {
+            if (incremental) mark(now, std::min(covered_from, window_start));
+            else mark(now, window_start, true);
+        }
+        publish(true, on_progress);
+    }
+
+    // sacct queries for [from, to) (to = 0: up to now), SLICE long at most, newest first
+    static void addSlices(std::vector<std::string>& queries, const std::string& sacct, int64_t from, int64_t to,
+                          int64_t now) {
+        int64_t end = to == 0 ? now : to;
+        while (true) {
+            int64_t start = std::max(from, end - SLICE);
+            std::string cmd = sacct + " --starttime=" + history::formatTime(start);
+            if (to != 0 || end != now) cmd += " --endtime=" + history::formatTime(end);
+            queries.push_back(cmd);
+            if (start <= from) break;
+            end = start;
+        }
+    }
+
+    // Append the fetched jobs that differ from the stored ones
+    void save(const Jobs& fetched) {
+        append([&](std::string& out) {
+            for (const auto& job : fetched) {
+                auto it = records_.find(job.id);
+                if (it != records_.end() && *it->second == job) continue;
+                records_[job.id] = std::make_shared<const HistoryJob>(job);
+                appendJob(out, job);
+                entries_++;
+            }
+        });
+    }
+
+    // Sync marker, once every query of a sync is stored. `reset` after a
+    // full fetch of the window: a range covered before it is not contiguous
+    // with it any more.
+    void mark(int64_t now, int64_t covered_from, bool reset = false) {
+        append([&](std::string& out) {
+            synced_at_ = std::max(synced_at_, now);
+            covered_from_ = reset || covered_from_ == 0 ? covered_from : std::min(covered_from_, covered_from);
+            appendSync(out, synced_at_, covered_from_);
+        });
+    }
+
+    // Append what `build` writes (under the store lock), after what other
+    // instances appended; one writer at a time within the process as well
+    template <typename F>
+    void append(F&& build) {
+        std::lock_guard<std::mutex> file_lock(file_mutex_);
+        int fd = lock();
+        if (fd >= 0) readNew(fd);  // Appended by another instance
+
+        std::string out;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            build(out);
+        }
+
+        if (fd < 0) return;
+        if (entries_ > 2 * records_.size() + 1000) {
+            rewrite();
+        } else {
+            // Over a torn entry, or a file that is not ours
+            if (ftruncate(fd, (off_t)end_) == 0) {
+                if (end_ == 0) out.insert(0, MAGIC, sizeof(MAGIC));
+                if (pwrite(fd, out.data(), out.size(), (off_t)end_) == (ssize_t)out.size()) end_ += out.size();
+            }
+        }
+        flock(fd, LOCK_UN);
+        ::close(fd);
+    }
+
+    // The file opened and locked, as it is at its path once locked (a rewrite replaces it)
+    int lock() {
+        for (int attempt = 0; attempt < 3; ++attempt) {
+            int fd = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+            if (fd < 0) return -1;
+            flock(fd, LOCK_EX);
+            struct stat locked, current;
+            if (fstat(fd, &locked) == 0 && stat(path_.c_str(), &current) == 0 &&
+                locked.st_dev == current.st_dev && locked.st_ino == current.st_ino)
+                return fd;
+            ::close(fd);
+        }
+        return -1;
+    }
+
+    // Live records only, old ones dropped; replaces the file (under its lock)
+    void rewrite() {
+        int64_t oldest = (int64_t)std::time(nullptr) - (int64_t)KEEP_DAYS * 86400;
+        std::string out(MAGIC, sizeof(MAGIC));
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto it = records_.begin(); it != records_.end();) {
+                int64_t end = history::parseTime(it->second->end);
+                if (end != 0 && end < oldest) {
+                    it = records_.erase(it);
+                } else {
+                    appendJob(out, *it->second);
+                    ++it;
+                }
+            }
+            appendSync(out, synced_at_, std::max(covered_from_, oldest));
+            covered_from_ = std::max(covered_from_, oldest);
+            entries_ = records_.size();
+        }
+        std::string tmp = path_ + ".tmp";
+        int out_fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (out_fd < 0) return;
+        bool ok = ::write(out_fd, out.data(), out.size()) == (ssize_t)out.size();
+        ::close(out_fd);
+        struct stat st;
+        if (ok && rename(tmp.c_str(), path_.c_str()) == 0 && stat(path_.c_str(), &st) == 0) {
+            end_ = out.size();
+            dev_ = st.st_dev;
+            ino_ = st.st_ino;
+        } else {
+            unlink(tmp.c_str());
+        }
+    }
+
+    // Entries past end_; a torn entry at the end (interrupted write) is left for the next append to overwrite
+    void readNew(int fd) {
+        struct stat st;
+        if (fstat(fd, &st) != 0) return;
+        // The file was replaced by a rewrite elsewhere: start over
+        if (dev_ != st.st_dev || ino_ != st.st_ino || (uint64_t)st.st_size < end_) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            records_.clear();
+            entries_ = 0;
+            end_ = 0;
+            dev_ = st.st_dev;
+            ino_ = st.st_ino;
+        }
+        if ((uint64_t)st.st_size <= end_) return;
+
+        std::string data((size_t)st.st_size - end_, '\0');
+        if (preadFull(fd, data.data(), data.size(), end_) != data.size()) return;
+        size_t pos = 0;
+        if (end_ == 0) {
+            if (data.size() < sizeof(MAGIC) || data.compare(0, sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0) return;
+            pos = sizeof(MAGIC);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (pos + 5 <= data.size()) {
+            uint8_t type = (uint8_t)data[pos];
+            uint32_t len;
+            std::memcpy(&len, data.data() + pos + 1, 4);
+            if (pos + 5 + len > data.size()) break;
+            const char* p = data.data() + pos + 5;
+            const char* end = p + len;
+            if (type == JOB) {
+                HistoryJob job;
+                bool ok = true;
+                for (size_t i = 0; i < HistoryJob::FIELDS && ok; ++i) {
+                    uint16_t n;
+                    if (end - p < 2) { ok = false; break; }
+                    std::memcpy(&n, p, 2);
+                    p += 2;
+                    if (end - p < n) { ok = false; break; }
+                    job.field(i).assign(p, n);
+                    p += n;
+                }
+                if (ok) {
+                    auto& record = records_[job.id];
+                    record = std::make_shared<const HistoryJob>(std::move(job));
+                    entries_++;
+                }
+            } else if (type == SYNC && len >= 16) {
+                int64_t at, from;
+                std::memcpy(&at, p, 8);
+                std::memcpy(&from, p + 8, 8);
+                synced_at_ = std::max(synced_at_, at);
+                covered_from_ = from;
+            }
+            pos += 5 + len;
+        }
+        end_ += pos;
+    }
+
+    static void appendEntry(std::string& out, Entry type, const std::string& payload) {
+        uint32_t len = (uint32_t)payload.size();
+        out += (char)type;
+        out.append(reinterpret_cast<const char*>(&len), 4);
+        out += payload;
+    }
+
+    static void appendJob(std::string& out, const HistoryJob& job) {
+        std::string payload;
+        for (size_t i = 0; i < HistoryJob::FIELDS; ++i) {
+            const std::string& f = job.field(i);
+            uint16_t n = (uint16_t)std::min<size_t>(f.size(), UINT16_MAX);
+            payload.append(reinterpret_cast<const char*>(&n), 2);
+            payload.append(f, 0, n);
+        }
+        appendEntry(out, JOB, payload);
+    }
+
+    static void appendSync(std::string& out, int64_t at, int64_t covered_from) {
+        std::string payload(16, '\0');
+        std::memcpy(&payload[0], &at, 8);
+        std::memcpy(&payload[8], &covered_from, 8);
+        appendEntry(out, SYNC, payload);
+    }
+
+    // Throttled while a sync streams in, unless `force`. The table is built
+    // outside the store lock (records are shared, not copied), one build at a
+    // time so that a later publish never gets replaced by an older table.
+    void publish(bool force = true, const std::function<void()>& on_progress = {}) {
+        if (!force) {
+            auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+            auto prev = last_publish_.load();
+            auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(PUBLISH_INTERVAL).count();
+            if (now - prev < interval || !last_publish_.compare_exchange_strong(prev, now)) return;
+        }
+        std::unique_lock<std::mutex> building(publish_mutex_, std::defer_lock);
+        if (force) building.lock();
+        else if (!building.try_lock()) return;  // The running build is recent enough
+
+        std::vector<std::shared_ptr<const HistoryJob>> jobs;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs.reserve(records_.size());
+            for (const auto& [id, job] : records_) jobs.push_back(job);
+        }
+        std::sort(jobs.begin(), jobs.end(), [](const auto& a, const auto& b) { return history::newer(*a, *b); });
+        auto table = std::make_shared<const HistoryTable>(jobs);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            table_ = std::move(table);
+        }
+        version_++;
+        if (!force && on_progress && !stopped_) on_progress();
+    }
+
+    std::string path_;
+
+    mutable std::mutex mutex_;
+    std::mutex file_mutex_;
+    std::mutex publish_mutex_;
+    std::map<std::string, std::shared_ptr<const HistoryJob>> records_;
+    std::shared_ptr<const HistoryTable> table_ = std::make_shared<HistoryTable>();
+    int64_t synced_at_ = 0;
+    int64_t covered_from_ = 0;  // Start of the time range fetched so far
+    size_t entries_ = 0;        // Job entries in the file, superseded ones included
+
+    // Part of the file already read
+    uint64_t end_ = 0;
+    dev_t dev_ = 0;
+    ino_t ino_ = 0;
+
+    std::atomic<uint64_t> version_{0};
+    std::atomic<bool> busy_{false};
+    int queued_days_ = 0;  // Sync asked for while one was running (under mutex_)
+    std::function<void()> queued_done_;
+    std::atomic<bool> stopped_{false};
+    std::atomic<size_t> slices_done_{0};
+    std::atomic<size_t> slices_total_{0};
+    std::atomic<int64_t> last_publish_{0};
+    std::thread worker_;
+};
+
+}
@@ -0,0 +1,212 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "history_job.hpp"
+
+namespace api {
+
+enum class JobState : uint8_t {
+    Pending, Running, Completed, Failed, Cancelled, Timeout, OutOfMemory, NodeFail, Preempted, Other
+};
+
+namespace history {
+
+inline JobState parseState(const std::string& s) {
+    static const std::pair<const char*, JobState> prefixes[] = {
+        {"PENDING", JobState::Pending},     {"RUNNING", JobState::Running},
+        {"COMPLETED", JobState::Completed}, {"FAILED", JobState::Failed},
+        {"CANCELLED", JobState::Cancelled}, {"TIMEOUT", JobState::Timeout},
+        {"OUT_OF_ME", JobState::OutOfMemory}, {"NODE_FAIL", JobState::NodeFail},
+        {"PREEMPTED", JobState::Preempted},
+    };
+    for (const auto& [prefix, state] : prefixes)
+        if (s.compare(0, std::char_traits<char>::length(prefix), prefix) == 0) return state;
+    return JobState::Other;
+}
+
+// "[D-]HH:MM:SS", "MM:SS" or "MM:SS.mmm" in seconds; -1 when empty or invalid
+inline int64_t parseDuration(const std::string& s) {
+    if (s.empty() || !std::isdigit((unsigned char)s[0])) return -1;
+    int64_t days = 0;
+    size_t pos = 0;
+    size_t dash = s.find('-');
+    if (dash != std::string::npos) {
+        days = std::atoll(s.c_str());
+        pos = dash + 1;
+    }
+    int64_t parts[3] = {0, 0, 0};
+    int count = 0;
+    while (pos < s.size() && count < 3) {
+        char* end;
+        parts[count++] = std::strtoll(s.c_str() + pos, &end, 10);
+        pos = (size_t)(end - s.c_str());
+        if (pos >= s.size() || s[pos] != ':') break;
+        pos++;
+    }
+    int64_t seconds = count == 3 ? parts[0] * 3600 + parts[1] * 60 + parts[2] : parts[0] * 60 + parts[1];
+    return days * 86400 + seconds;
+}
+
+// "2:0" (exit code:signal) as one sortable number
+inline int32_t parseExitCode(const std::string& s) {
+    size_t colon = s.find(':');
+    int code = std::atoi(s.c_str());
+    int signal = colon == std::string::npos ? 0 : std::atoi(s.c_str() + colon + 1);
+    return code * 256 + signal;
+}
+
+}
+
+// The history parsed once into typed columns (one vector per field), so that
+// it can be sorted and aggregated without touching strings again. Sort
+// orders are permutations of the rows, computed on first use per column and
+// kept with the table; a descending order is the same permutation read
+// backwards. A table is immutable once built and may be read from several
+// threads, the lazy orders included.
+class HistoryTable {
+public:
+    enum Column : uint8_t { Id, Name, State, Start, End, Elapsed, CpuTime, Cpus, Nodes, Memory, Exit, Partition, COLUMNS };
+
+    // Text columns, as sacct printed them
+    std::vector<std::string> id, name, state_text, exit_text, partition, account;
+    // Numeric columns; -1 (0 for timestamps) when unknown
+    std::vector<uint64_t> job_id;     // Base id of an array task
+    std::vector<int32_t> task;        // Array task id, -1 outside an array
+    std::vector<JobState> state;
+    std::vector<int64_t> start, end;  // Epoch seconds
+    std::vector<int64_t> elapsed, cpu_time;  // Seconds
+    std::vector<int32_t> ncpus, nnodes;
+    std::vector<int32_t> ntasks;      // Tasks of the largest step
+    std::vector<int64_t> max_rss;     // Bytes, largest task of any step
+    std::vector<int32_t> exit_code;   // code * 256 + signal
+    std::vector<int64_t> total_cpu;   // CPU seconds used
+    std::vector<int64_t> req_mem;     // Bytes requested for the whole job
+    std::vector<int64_t> time_limit;  // Seconds, -1 when unlimited
+    std::vector<std::string> search;  // Lowercase "name\tpartition", for the text filter
+
+    HistoryTable() = default;
+
+    explicit HistoryTable(const std::vector<HistoryJob>& jobs) {
+        reserve(jobs.size());
+        for (const auto& job : jobs) add(job);
+        order(Id);
+    }
+
+    // Built by the history store from its records, off the UI thread
+    explicit HistoryTable(const std::vector<std::shared_ptr<const HistoryJob>>& jobs) {
+        reserve(jobs.size());
+        for (const auto& job : jobs) add(*job);
+        order(Id);
+    }
+
+    size_t size() const { return id.size(); }
+
+    // Rows in ascending order of `column`, ties broken by job id then task
+    const std::vector<uint32_t>& order(Column column) const {
+        std::call_once(ordered_[column], [&] { sortBy(column); });
+        return orders_[column];
+    }
+
+    // `rows` (a subset, as a mask over all rows) in the order of `column`
+    std::vector<uint32_t> sorted(const std::vector<uint8_t>& mask, Column column, bool descending) const {
+        const auto& perm = order(column);
+        std::vector<uint32_t> out;
+        if (descending) {
+            for (auto it = perm.rbegin(); it != perm.rend(); ++it)
+                if (mask[*it]) out.push_back(*it);
+        } else {
+            for (uint32_t row : perm)
+                if (mask[row]) out.push_back(row);
+        }
+        return out;
+    }
+
+private:
+    void reserve(size_t n) {
+        for (auto* column : {&id, &name, &state_text, &exit_text, &partition, &account}) column->reserve(n);
+        job_id.reserve(n); task.reserve(n); state.reserve(n);
+        start.reserve(n); end.reserve(n); elapsed.reserve(n); cpu_time.reserve(n);
+        ncpus.reserve(n); nnodes.reserve(n); ntasks.reserve(n); max_rss.reserve(n); exit_code.reserve(n);
+        total_cpu.reserve(n); req_mem.reserve(n); time_limit.reserve(n); search.reserve(n);
+    }
+
+    void add(const HistoryJob& job) {
+        id.push_back(job.id);
+        name.push_back(job.name);
+        state_text.push_back(job.state);
+        exit_text.push_back(job.exit_code);
+        partition.push_back(job.partition);
+        account.push_back(job.account);
+
+        job_id.push_back(std::strtoull(job.id.c_str(), nullptr, 10));
+        size_t underscore = job.id.find('_');
+        task.push_back(underscore == std::string::npos ? -1 : std::atoi(job.id.c_str() + underscore + 1));
+        state.push_back(history::parseState(job.state));
+        start.push_back(history::parseTime(job.start));
+        end.push_back(history::parseTime(job.end));
+        elapsed.push_back(history::parseDuration(job.elapsed));
+        cpu_time.push_back(history::parseDuration(job.cpu_time));
+        ncpus.push_back(job.ncpus.empty() ? -1 : std::atoi(job.ncpus.c_str()));
+        nnodes.push_back(job.nnodes.empty() ? -1 : std::atoi(job.nnodes.c_str()));
+        ntasks.push_back(job.ntasks.empty() ? -1 : std::atoi(job.ntasks.c_str()));
+        max_rss.push_back(history::parseMemory(job.max_rss));
+        exit_code.push_back(history::parseExitCode(job.exit_code));
+        total_cpu.push_back(history::parseDuration(job.total_cpu));
+        time_limit.push_back(history::parseDuration(job.time_limit));
+
+        // Older Slurm suffixes ReqMem with n (per node) or c (per CPU)
+        int64_t mem = history::parseMemory(job.req_mem);
+        char scope = job.req_mem.empty() ? ' ' : job.req_mem.back();
+        if (mem > 0 && scope == 'n' && nnodes.back() > 0) mem *= nnodes.back();
+        if (mem > 0 && scope == 'c' && ncpus.back() > 0) mem *= ncpus.back();
+        req_mem.push_back(mem);
+
+        std::string text = job.name + "\t" + job.partition;
+        for (char& c : text) c = (char)std::tolower((unsigned char)c);
+        search.push_back(std::move(text));
+    }
+
+    void sortBy(Column column) const {
+        auto& perm = orders_[column];
+        if (column == Id) {
+            perm.resize(size());
+            std::iota(perm.begin(), perm.end(), 0u);
+            std::sort(perm.begin(), perm.end(), [&](uint32_t a, uint32_t b) {
+                return job_id[a] != job_id[b] ? job_id[a] < job_id[b] : task[a] < task[b];
+            });
+            return;
+        }
+        perm = order(Id);
+        auto by = [&](const auto& values) {
+            std::stable_sort(perm.begin(), perm.end(), [&](uint32_t a, uint32_t b) { return values[a] < values[b]; });
+        };
+        switch (column) {
+            case Id: break;
+            case Name: by(name); break;
+            case State: by(state); break;
+            case Start: by(start); break;
+            case End: by(end); break;
+            case Elapsed: by(elapsed); break;
+            case CpuTime: by(cpu_time); break;
+            case Cpus: by(ncpus); break;
+            case Nodes: by(nnodes); break;
+            case Memory: by(max_rss); break;
+            case Exit: by(exit_code); break;
+            case Partition: by(partition); break;
+            case COLUMNS: break;
+        }
+    }
+
+    mutable std::array<std::vector<uint32_t>, COLUMNS> orders_;
+    mutable std::array<std::once_flag, COLUMNS> ordered_;
+};
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace api {
+
+// Dynamic bitset of small non-negative ids (CPU ids, GPU indices).
+// Membership is O(1), totals use popcount, iteration skips empty words.
+class IndexSet {
+public:
+    IndexSet() = default;
+
+    // Parse a Slurm id list such as "0-3,8,10-11"
+    static IndexSet parse(const std::string& list) {
+        IndexSet set;
+        size_t i = 0;
+        while (i < list.size()) {
+            if (!isDigit(list[i])) { i++; continue; }
+            int first = readInt(list, i);
+            int last = first;
+            if (i < list.size() && list[i] == '-' && i + 1 < list.size() && isDigit(list[i + 1])) {
+                i++;
+                last = readInt(list, i);
+            }
+            set.insertRange(first, last);
+        }
+        return set;
+    }
+
+    void insert(int id) {
+        if (id < 0) return;
+        grow(id);
+        words_[id >> 6] |= bit(id);
+    }
+
+    // Insert [first, last] (inclusive), filling whole words at once
+    void insertRange(int first, int last) {
+        if (first < 0 || last < first) return;
+        grow(last);
+        int fw = first >> 6, lw = last >> 6;
+        uint64_t head = ~uint64_t(0) << (first & 63);
+        uint64_t tail = ~uint64_t(0) >> (63 - (last & 63));
+        if (fw == lw) {
+            words_[fw] |= head & tail;
+            return;
+        }
+        words_[fw] |= head;
+        for (int w = fw + 1; w < lw; ++w) words_[w] = ~uint64_t(0);
+        words_[lw] |= tail;
+    }
+
+    bool contains(int id) const {
+        if (id < 0 || (size_t)(id >> 6) >= words_.size()) return false;
+        return (words_[id >> 6] & bit(id)) != 0;
+    }
+
+    int count() const {
+        int n = 0;
+        for (uint64_t w : words_) n += popcount(w);
+        return n;
+    }
+
+    bool empty() const {
+        for (uint64_t w : words_) if (w) return false;
+        return true;
+    }
+
+    void clear() { words_.clear(); }
+
+    // Call f(id) for every set id, in increasing order
+    template <typename F>
+    void forEach(F&& f) const {
+        for (size_t w = 0; w < words_.size(); ++w) {
+            uint64_t word = words_[w];
+            while (word) {
+                f((int)(w << 6) + ctz(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    const std::vector<uint64_t>& words() const { return words_; }
+
+private:
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    static int readInt(const std::string& s, size_t& i) {
+        int v = 0;
+        while (i < s.size() && isDigit(s[i])) v = v * 10 + (s[i++] - '0');
+        return v;
+    }
+
+    static uint64_t bit(int id) { return uint64_t(1) << (id & 63); }
+
+    static int popcount(uint64_t w) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(w);
+#else
+        int n = 0;
+        for (; w; w &= w - 1) n++;
+        return n;
+#endif
+    }
+
+    static int ctz(uint64_t w) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(w);
+#else
+        int n = 0;
+        while (!(w & 1)) { w >>= 1; n++; }
+        return n;
+#endif
+    }
+
+    void grow(int id) {
+        size_t needed = (size_t)(id >> 6) + 1;
+        if (words_.size() < needed) words_.resize(needed, 0);
+    }
+
+    std::vector<uint64_t> words_;
+};
+
+}
@@ -0,0 +1,292 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "slurmjobs.hpp"
+
+namespace api {
+
+// Conjunction of (index, key) terms, e.g. "user:alice state:pending"
+struct JobFilter {
+    std::vector<std::pair<uint8_t, std::string>> terms;
+    bool empty() const { return terms.empty(); }
+};
+
+// The squeue snapshot as dense rows, with secondary indexes by user,
+// account, partition, state and node: each maps a key to the rows holding it,
+// so counting, grouping and filtering never scan the whole queue. A refresh
+// is applied as a diff against the previous snapshot: unchanged jobs keep
+// their row, changed ones are patched in place and only their index entries
+// move, and rows of vanished jobs are reused by new ones.
+class JobTable {
+public:
+    enum Index : uint8_t { User, Account, Partition, State, Node, INDEXES };
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // Applies a new snapshot; returns the number of rows added, patched or
+    // removed. Only those jobs are copied into the table.
+    size_t update(const std::vector<Job>& fresh) {
+        size_t touched = 0;
+        std::vector<uint8_t> seen(rows_.size() + fresh.size(), 0);
+        order_.clear();
+        order_.reserve(fresh.size());
+        for (const auto& job : fresh) {
+            uint32_t row;
+            auto it = by_id_.find(job.id);
+            if (it == by_id_.end()) {
+                row = insert(job);
+                touched++;
+            } else {
+                row = it->second;
+                if (!sameJob(rows_[row], job)) {
+                    patch(row, job);
+                    touched++;
+                }
+            }
+            if (seen[row]) continue;  // Same id twice in one output
+            seen[row] = 1;
+            rank_[row] = (uint32_t)order_.size();
+            order_.push_back(row);
+        }
+        for (uint32_t row = 0; row < rows_.size(); ++row) {
+            if (live_[row] && !seen[row]) {
+                erase(row);
+                touched++;
+            }
+        }
+        if (touched > 0) version_++;
+        return touched;
+    }
+
+    size_t size() const { return order_.size(); }
+    bool empty() const { return order_.empty(); }
+    // Bumped by every update that changed a row
+    uint64_t version() const { return version_; }
+
+    const Job& job(uint32_t row) const { return rows_[row]; }
+    uint32_t find(const std::string& id) const {
+        auto it = by_id_.find(id);
+        return it == by_id_.end() ? NONE : it->second;
+    }
+    // Rows in squeue order
+    const std::vector<uint32_t>& order() const { return order_; }
+    // Position of a row in squeue order
+    uint32_t rank(uint32_t row) const { return rank_[row]; }
+
+    // Rows with `key` in `index`, in no particular order
+    const std::vector<uint32_t>& rows(Index index, const std::string& key) const {
+        static const std::vector<uint32_t> none;
+        const auto& lists = indexes_[index].lists;
+        auto it = lists.find(key);
+        return it == lists.end() ? none : it->second;
+    }
+    size_t count(Index index, const std::string& key) const { return rows(index, key).size(); }
+
+    // Keys of an index with their job count, most jobs first
+    std::vector<std::pair<std::string, size_t>> groups(Index index) const {
+        std::vector<std::pair<std::string, size_t>> out;
+        out.reserve(indexes_[index].lists.size());
+        for (const auto& [key, list] : indexes_[index].lists) out.emplace_back(key, list.size());
+        sortGroups(out);
+        return out;
+    }
+
+    // Same, over a subset of the rows (a filter result)
+    std::vector<std::pair<std::string, size_t>> groups(Index index, const std::vector<uint32_t>& rows) const {
+        if (rows.size() == order_.size()) return groups(index);
+        std::unordered_map<std::string, size_t> counts;
+        for (uint32_t row : rows) {
+            if (index == Node) {
+                for (const auto& node : nodes_[row]) counts[node]++;
+            } else {
+                counts[key(index, rows_[row])]++;
+            }
+        }
+        std::vector<std::pair<std::string, size_t>> out(counts.begin(), counts.end());
+        sortGroups(out);
+        return out;
+    }
+
+    // Rows matching every term, in squeue order. Candidates come from the
+    // shortest posting list of the terms; the others are checked per row.
+    std::vector<uint32_t> select(const JobFilter& filter) const {
+        if (filter.empty()) return order_;
+        const std::vector<uint32_t>* shortest = nullptr;
+        for (const auto& [index, key] : filter.terms) {
+            const auto& list = rows((Index)index, key);
+            if (!shortest || list.size() < shortest->size()) shortest = &list;
+        }
+        std::vector<uint32_t> out;
+        for (uint32_t row : *shortest) {
+            bool match = true;
+            for (const auto& [index, key] : filter.terms) match = match && holds(row, (Index)index, key);
+            if (match) out.push_back(row);
+        }
+        std::sort(out.begin(), out.end(), [&](uint32_t a, uint32_t b) { return rank_[a] < rank_[b]; });
+        return out;
+    }
+
+    static const char* indexName(Index index) {
+        static const char* names[] = {"user", "account", "partition", "state", "node"};
+        return index < INDEXES ? names[index] : "";
+    }
+
+    // "user:alice state:pending node:romeo-a045"; a term is "index:key" with
+    // the index name or its first letter, a bare word is a user
+    static JobFilter parseFilter(const std::string& query) {
+        JobFilter filter;
+        std::istringstream words(query);
+        std::string word;
+        while (words >> word) {
+            Index index = User;
+            size_t colon = word.find(':');
+            if (colon != std::string::npos) {
+                std::string name = word.substr(0, colon);
+                for (uint8_t i = 0; i < INDEXES; ++i) {
+                    std::string full = indexName((Index)i);
+                    if (name == full || name == full.substr(0, 1)) index = (Index)i;
+                }
+                word = word.substr(colon + 1);
+            }
+            if (word.empty()) continue;
+            if (index == State)
+                for (auto& c : word) c = (char)std::toupper((unsigned char)c);
+            filter.terms.emplace_back(index, word);
+        }
+        return filter;
+    }
+
+private:
+    // Key -> rows. Single-valued indexes remember each row's position in its
+    // list, so that removal is a swap with the last entry. A row is listed
+    // under each of its nodes; a node holds few jobs, so removal scans its list.
+    struct KeyIndex {
+        std::unordered_map<std::string, std::vector<uint32_t>> lists;
+        std::vector<uint32_t> pos;
+
+        void add(uint32_t row, const std::string& key) {
+            auto& list = lists[key];
+            if (pos.size() <= row) pos.resize(row + 1);
+            pos[row] = (uint32_t)list.size();
+            list.push_back(row);
+        }
+        void remove(uint32_t row, const std::string& key) {
+            auto it = lists.find(key);
+            if (it == lists.end()) return;
+            auto& list = it->second;
+            uint32_t at = pos[row];
+            uint32_t last = list.back();
+            list[at] = last;
+            pos[last] = at;
+            list.pop_back();
+            if (list.empty()) lists.erase(it);
+        }
+        void removeScan(uint32_t row, const std::string& key) {
+            auto it = lists.find(key);
+            if (it == lists.end()) return;
+            auto& list = it->second;
+            auto found = std::find(list.begin(), list.end(), row);
+            if (found == list.end()) return;
+            *found = list.back();
+            list.pop_back();
+            if (list.empty()) lists.erase(it);
+        }
+    };
+
+    static const std::string& key(Index index, const Job& job) {
+        switch (index) {
+            case User: return job.user;
+            case Account: return job.account;
+            case Partition: return job.partition;
+            default: return job.state;
+        }
+    }
+
+    static bool sameJob(const Job& a, const Job& b) {
+        return a.state == b.state && a.nodelist == b.nodelist && a.cpus == b.cpus && a.nodes == b.nodes &&
+               a.mem_mb == b.mem_mb && a.gpus == b.gpus && a.name == b.name && a.user == b.user &&
+               a.account == b.account && a.partition == b.partition;
+    }
+
+    bool holds(uint32_t row, Index index, const std::string& k) const {
+        if (index != Node) return key(index, rows_[row]) == k;
+        const auto& nodes = nodes_[row];
+        return std::find(nodes.begin(), nodes.end(), k) != nodes.end();
+    }
+
+    void indexRow(uint32_t row) {
+        for (uint8_t i = 0; i < Node; ++i) indexes_[i].add(row, key((Index)i, rows_[row]));
+        nodes_[row] = rows_[row].nodelist.empty() ? std::vector<std::string>{}
+                                                  : slurm::expandNodelist(rows_[row].nodelist);
+        for (const auto& node : nodes_[row]) indexes_[Node].add(row, node);
+    }
+
+    uint32_t insert(Job job) {
+        uint32_t row;
+        if (!free_.empty()) {
+            row = free_.back();
+            free_.pop_back();
+            rows_[row] = std::move(job);
+            live_[row] = 1;
+        } else {
+            row = (uint32_t)rows_.size();
+            rows_.push_back(std::move(job));
+            live_.push_back(1);
+            nodes_.emplace_back();
+            rank_.push_back(0);
+        }
+        by_id_[rows_[row].id] = row;
+        indexRow(row);
+        return row;
+    }
+
+    void patch(uint32_t row, Job job) {
+        Job& old = rows_[row];
+        for (uint8_t i = 0; i < Node; ++i) {
+            const std::string& before = key((Index)i, old);
+            const std::string& after = key((Index)i, job);
+            if (before == after) continue;
+            indexes_[i].remove(row, before);
+            indexes_[i].add(row, after);
+        }
+        if (old.nodelist != job.nodelist) {
+            for (const auto& node : nodes_[row]) indexes_[Node].removeScan(row, node);
+            nodes_[row] = job.nodelist.empty() ? std::vector<std::string>{} : slurm::expandNodelist(job.nodelist);
+            for (const auto& node : nodes_[row]) indexes_[Node].add(row, node);
+        }
+        old = std::move(job);
+    }
+
+    void erase(uint32_t row) {
+        for (uint8_t i = 0; i < Node; ++i) indexes_[i].remove(row, key((Index)i, rows_[row]));
+        for (const auto& node : nodes_[row]) indexes_[Node].removeScan(row, node);
+        by_id_.erase(rows_[row].id);
+        rows_[row] = Job{};
+        nodes_[row].clear();
+        live_[row] = 0;
+        free_.push_back(row);
+    }
+
+    static void sortGroups(std::vector<std::pair<std::string, size_t>>& groups) {
+        std::sort(groups.begin(), groups.end(), [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+    }
+
+    std::vector<Job> rows_;
+    std::vector<uint8_t> live_;
+    std::vector<std::vector<std::string>> nodes_;  // Expanded node list per row
+    std::vector<uint32_t> rank_;
+    std::vector<uint32_t> free_;
+    std::vector<uint32_t> order_;
+    std::unordered_map<std::string, uint32_t> by_id_;
+    KeyIndex indexes_[INDEXES];
+    uint64_t version_ = 0;
+};
+
+}
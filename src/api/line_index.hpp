@@ -0,0 +1,406 @@
+#pragma once
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "aho_corasick.hpp"
+#include "log_file.hpp"
+#include "log_patterns.hpp"
+#include "log_reader.hpp"
+
+namespace api {
+
+// Sampled line-offset table of a file: the byte offset of every STRIDE-th
+// line start (8 bytes per 1024 lines, under 1 MB for 100M lines). Built on a
+// background thread and extended incrementally as the file grows. The same
+// pass classifies every line with logPatterns() and keeps the numbers of the
+// error and warning lines. Compressed files are indexed on their content;
+// the pass also lays the decompression checkpoints later reads resume from.
+class LineIndex {
+public:
+    static constexpr uint64_t STRIDE = 1024;
+    static constexpr size_t BLOCK_SIZE = 1 << 20;
+    static constexpr auto PROGRESS_INTERVAL = std::chrono::milliseconds(250);
+    // Indexes kept alive by forFile() so reopening a log does not rescan it
+    static constexpr size_t REGISTRY_SIZE = 16;
+
+    explicit LineIndex(std::string path) : path_(std::move(path)) {}
+
+    ~LineIndex() {
+        stop_ = true;
+        if (thread_.joinable()) thread_.join();
+    }
+
+    LineIndex(const LineIndex&) = delete;
+    LineIndex& operator=(const LineIndex&) = delete;
+
+    // Process-wide index for a path, most recently used ones kept
+    static std::shared_ptr<LineIndex> forFile(const std::string& path) {
+        static std::mutex mutex;
+        static std::list<std::shared_ptr<LineIndex>> recent;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = recent.begin(); it != recent.end(); ++it) {
+            if ((*it)->path() == path) {
+                recent.splice(recent.begin(), recent, it);
+                return recent.front();
+            }
+        }
+        recent.push_front(std::make_shared<LineIndex>(path));
+        if (recent.size() > REGISTRY_SIZE) recent.pop_back();
+        return recent.front();
+    }
+
+    // Index whatever was appended since the last pass, in the background.
+    // A shrunk or replaced file is indexed again from scratch. A compressed
+    // file is not appended to: it is indexed once, to the end of its content.
+    // on_progress is called from the indexing thread until detached with the
+    // returned subscription (a later update() takes the callback over).
+    uint64_t update(std::function<void()> on_progress = {}) {
+        uint64_t subscription;
+        {
+            std::lock_guard<std::mutex> lock(callback_mutex_);
+            on_progress_ = std::move(on_progress);
+            subscription = ++subscription_;
+        }
+        if (running_) return subscription;
+        if (thread_.joinable()) thread_.join();
+
+        struct stat st;
+        if (::stat(path_.c_str(), &st) != 0) return subscription;
+        uint64_t size = (uint64_t)st.st_size;
+        Compression compression = detectCompression(path_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            bool replaced = st.st_ino != ino_ || st.st_dev != dev_ || compression != compression_;
+            if (compression == Compression::None) replaced = replaced || size < indexed_;
+            else replaced = replaced || size != disk_size_;
+            if (replaced) {
+                samples_.assign(1, 0);
+                error_lines_.clear();
+                warning_lines_.clear();
+                cursor_ = AhoCorasick::Cursor();
+                newlines_ = 0;
+                indexed_ = 0;
+                last_partial_ = false;
+                ino_ = st.st_ino;
+                dev_ = st.st_dev;
+                compression_ = compression;
+                consumed_ = 0;
+                target_ = compression == Compression::None ? size : UNKNOWN_SIZE;
+            }
+            disk_size_ = size;
+            if (compression == Compression::None) target_ = size;
+            if (target_ == indexed_) return subscription;
+        }
+
+        running_ = true;
+        thread_ = std::thread([this] { run(); });
+        return subscription;
+    }
+
+    // Stop notifying; indexing itself carries on so the work is not lost
+    void detach(uint64_t subscription) {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        if (subscription == subscription_) on_progress_ = nullptr;
+    }
+
+    const std::string& path() const { return path_; }
+    bool indexing() const { return running_; }
+
+    bool complete() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return !running_ && indexed_ == target_;
+    }
+
+    // Lines seen so far, an unterminated last line included
+    uint64_t lineCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return newlines_ + (last_partial_ ? 1 : 0);
+    }
+
+    uint64_t indexedBytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return indexed_;
+    }
+
+    // Size of the content when the last pass started; 0 while unknown (a
+    // compressed file before the end of its first pass)
+    uint64_t fileSize() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return target_ == UNKNOWN_SIZE ? 0 : target_;
+    }
+
+    // Percent of the file read by the current pass
+    int progress() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (compression_ != Compression::None) return disk_size_ ? (int)(100 * consumed_ / disk_size_) : 0;
+        return target_ ? (int)(100 * indexed_ / target_) : 0;
+    }
+
+    // Nearest sample at or before `line`: sets its byte offset, returns its line
+    uint64_t seek(uint64_t line, uint64_t& offset) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t k = std::min<uint64_t>(line / STRIDE, samples_.size() - 1);
+        offset = samples_[k];
+        return k * STRIDE;
+    }
+
+    // First line of the sample containing a byte offset (STRIDE-line precision)
+    uint64_t lineAtOffset(uint64_t offset) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::upper_bound(samples_.begin(), samples_.end(), offset);
+        return (uint64_t)(it - samples_.begin() - 1) * STRIDE;
+    }
+
+    uint32_t rangeTags(uint64_t begin, uint64_t end) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (anyIn(error_lines_, begin, end) ? LOG_ERROR : 0) |
+               (anyIn(warning_lines_, begin, end) ? LOG_WARNING : 0);
+    }
+
+    // Next (or previous) error line strictly after (before) `line`
+    bool nextError(uint64_t line, bool forward, uint64_t& found) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (forward) {
+            auto it = std::upper_bound(error_lines_.begin(), error_lines_.end(), line);
+            if (it == error_lines_.end()) return false;
+            found = *it;
+        } else {
+            auto it = std::lower_bound(error_lines_.begin(), error_lines_.end(), line);
+            if (it == error_lines_.begin()) return false;
+            found = *--it;
+        }
+        return true;
+    }
+
+    size_t errorCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return error_lines_.size();
+    }
+
+    // Line containing a byte offset: nearest sample, then newlines counted up
+    // to the offset. False while the index has not reached it.
+    bool lineOfOffset(uint64_t offset, uint64_t& line) const {
+        uint64_t start;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (offset >= indexed_) return false;
+            size_t k = (size_t)(std::upper_bound(samples_.begin(), samples_.end(), offset) - samples_.begin() - 1);
+            start = samples_[k];
+            line = k * STRIDE;
+        }
+
+        auto file = LogFile::open(path_);
+        if (!file) return false;
+        std::vector<char> block((size_t)std::min<uint64_t>(BLOCK_SIZE, offset - start + 1));
+        while (start < offset) {
+            size_t n = file->read(block.data(), (size_t)std::min<uint64_t>(block.size(), offset - start), start);
+            if (n == 0) break;
+            line += (uint64_t)std::count(block.data(), block.data() + n, '\n');
+            start += n;
+        }
+        return true;
+    }
+
+private:
+    void run() {
+        auto file = LogFile::open(path_);
+        if (file) {
+            std::vector<char> block(BLOCK_SIZE);
+            std::vector<uint64_t> found, errors, warnings;
+            const auto& patterns = logPatterns();
+            auto last_progress = std::chrono::steady_clock::now();
+
+            uint64_t pos, end, newlines;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                pos = indexed_;
+                end = target_;
+                newlines = newlines_;
+            }
+
+            while (pos < end && !stop_) {
+                size_t n = file->read(block.data(), (size_t)std::min<uint64_t>(BLOCK_SIZE, end - pos), pos);
+                if (n == 0) break;
+
+                found.clear();
+                errors.clear();
+                warnings.clear();
+                patterns.feed(cursor_, block.data(), n, [&](size_t i, uint32_t tags) {
+                    if (tags & LOG_ERROR) errors.push_back(newlines);
+                    else if (tags & LOG_WARNING) warnings.push_back(newlines);
+                    if (++newlines % STRIDE == 0) found.push_back(pos + i + 1);
+                });
+                pos += n;
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    samples_.insert(samples_.end(), found.begin(), found.end());
+                    for (uint64_t line : errors) tagLine(line, LOG_ERROR);
+                    for (uint64_t line : warnings) tagLine(line, LOG_WARNING);
+                    newlines_ = newlines;
+                    indexed_ = pos;
+                    consumed_ = file->consumed();
+                    last_partial_ = block[n - 1] != '\n';
+                }
+
+                auto now = std::chrono::steady_clock::now();
+                if (now - last_progress >= PROGRESS_INTERVAL) {
+                    last_progress = now;
+                    notify();
+                }
+            }
+
+            // Shorter than stat said: the file was truncated during the pass
+            // (or the end of a compressed file's content was reached)
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pos < end && !stop_) target_ = pos;
+
+            // Tags are reported at '\n': those of an unterminated last line
+            // are still in the cursor (the end closes a whole-word match)
+            if (!stop_ && last_partial_) tagLine(newlines, cursor_.tags | cursor_.pending);
+        }
+        running_ = false;
+        notify();
+    }
+
+    // With mutex_ held. A line tagged while unterminated is tagged again once
+    // its '\n' is read, possibly with more tags.
+    void tagLine(uint64_t line, uint32_t tags) {
+        auto last = [&](const std::vector<uint64_t>& lines) { return !lines.empty() && lines.back() == line; };
+        if (tags & LOG_ERROR) {
+            if (last(warning_lines_)) warning_lines_.pop_back();
+            if (!last(error_lines_)) error_lines_.push_back(line);
+        } else if ((tags & LOG_WARNING) && !last(error_lines_) && !last(warning_lines_)) {
+            warning_lines_.push_back(line);
+        }
+    }
+
+    static bool anyIn(const std::vector<uint64_t>& lines, uint64_t begin, uint64_t end) {
+        auto it = std::lower_bound(lines.begin(), lines.end(), begin);
+        return it != lines.end() && *it < end;
+    }
+
+    void notify() {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        if (on_progress_) on_progress_();
+    }
+
+    static constexpr uint64_t UNKNOWN_SIZE = UINT64_MAX;
+
+    std::string path_;
+
+    mutable std::mutex mutex_;
+    std::vector<uint64_t> samples_{0};  // samples_[k] = offset of line k * STRIDE
+    std::vector<uint64_t> error_lines_;
+    std::vector<uint64_t> warning_lines_;
+    AhoCorasick::Cursor cursor_;        // Carries a line across blocks and passes
+    uint64_t newlines_ = 0;
+    uint64_t indexed_ = 0;
+    uint64_t target_ = 0;               // Content size to index, UNKNOWN_SIZE: to the end
+    bool last_partial_ = false;
+    ino_t ino_ = 0;
+    dev_t dev_ = 0;
+    Compression compression_ = Compression::None;
+    uint64_t disk_size_ = 0;
+    uint64_t consumed_ = 0;             // Bytes of the file on disk read by the pass
+
+    std::mutex callback_mutex_;
+    std::function<void()> on_progress_;
+    uint64_t subscription_ = 0;
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+// Whole-file line access through a LineIndex. Only a window of lines around
+// the last request is held in memory; moving outside it re-reads from the
+// nearest sample.
+class IndexedLog : public LineSource {
+public:
+    static constexpr size_t READ_BLOCK = 256 << 10;
+    static constexpr size_t MAX_WINDOW_BYTES = 16 << 20;
+    static constexpr uint64_t MARGIN = 256;  // Extra lines read past a request
+
+    explicit IndexedLog(std::shared_ptr<LineIndex> index)
+        : index_(std::move(index)), file_(LogFile::open(index_->path())) {}
+
+    IndexedLog(const IndexedLog&) = delete;
+    IndexedLog& operator=(const IndexedLog&) = delete;
+
+    const LineIndex& index() const { return *index_; }
+
+    size_t lineCount() const override { return (size_t)index_->lineCount(); }
+
+    uint32_t rangeTags(size_t begin, size_t end) const override { return index_->rangeTags(begin, end); }
+
+    void visit(size_t first, size_t count, const Visitor& f) const override {
+        size_t total = lineCount();
+        if (first >= total) return;
+        count = std::min(count, total - first);
+        if (first < window_first_ || first + count > window_first_ + lines_.size()) load(first, count);
+
+        size_t end = std::min<size_t>(first + count, window_first_ + lines_.size());
+        for (size_t i = std::max<size_t>(first, window_first_); i < end; ++i) f(i, lines_[i - window_first_]);
+    }
+
+private:
+    void load(uint64_t first, size_t count) const {
+        buffer_.clear();
+        lines_.clear();
+        if (!file_) return;
+
+        uint64_t offset = 0;
+        window_first_ = index_->seek(first, offset);
+        uint64_t wanted = first + count + MARGIN - window_first_;
+
+        // Read whole blocks until the wanted lines are complete or EOF
+        uint64_t newlines = 0;
+        bool eof = false;
+        while (newlines < wanted && buffer_.size() < MAX_WINDOW_BYTES) {
+            size_t old = buffer_.size();
+            buffer_.resize(old + READ_BLOCK);
+            size_t n = file_->read(buffer_.data() + old, READ_BLOCK, offset + old);
+            buffer_.resize(old + n);
+            for (const char* p = buffer_.data() + old; p < buffer_.data() + old + n; ++p) {
+                p = static_cast<const char*>(std::memchr(p, '\n', (size_t)(buffer_.data() + old + n - p)));
+                if (!p) break;
+                newlines++;
+            }
+            if (n < READ_BLOCK) {
+                eof = true;
+                break;
+            }
+        }
+
+        const char* p = buffer_.data();
+        const char* end = p + buffer_.size();
+        while (p < end) {
+            auto* nl = static_cast<const char*>(std::memchr(p, '\n', (size_t)(end - p)));
+            if (!nl && !eof) break;  // Cut mid-line by the block boundary
+            const char* line_end = nl ? nl : end;
+            lines_.emplace_back(p, (size_t)(line_end - p));
+            p = line_end + 1;
+        }
+    }
+
+    std::shared_ptr<LineIndex> index_;
+    std::unique_ptr<LogFile> file_;
+
+    mutable uint64_t window_first_ = 0;
+    mutable std::vector<char> buffer_;
+    mutable std::vector<std::string_view> lines_;
+};
+
+}
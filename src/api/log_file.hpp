@@ -0,0 +1,649 @@
+#pragma once
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Optional decompressors, enabled by CMake when the library is found
+#ifdef RSV_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef RSV_HAVE_LZMA
+#include <lzma.h>
+#endif
+#ifdef RSV_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace api {
+
+// pread until n bytes are read, EOF or a real error. Returns bytes read.
+inline size_t preadFull(int fd, char* dst, size_t n, uint64_t offset) {
+    size_t done = 0;
+    while (done < n) {
+        ssize_t r = ::pread(fd, dst + done, n - done, (off_t)(offset + done));
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) break;
+        done += (size_t)r;
+    }
+    return done;
+}
+
+enum class Compression { None, Gzip, Xz, Zstd };
+
+// From the magic bytes, not the file name
+inline Compression detectCompression(int fd) {
+    unsigned char m[6] = {};
+    size_t n = preadFull(fd, reinterpret_cast<char*>(m), sizeof(m), 0);
+    if (n >= 2 && m[0] == 0x1f && m[1] == 0x8b) return Compression::Gzip;
+    if (n >= 4 && m[0] == 0x28 && m[1] == 0xb5 && m[2] == 0x2f && m[3] == 0xfd) return Compression::Zstd;
+    if (n >= 6 && std::memcmp(m, "\xfd" "7zXZ\0", 6) == 0) return Compression::Xz;
+    return Compression::None;
+}
+
+inline Compression detectCompression(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return Compression::None;
+    Compression c = detectCompression(fd);
+    ::close(fd);
+    return c;
+}
+
+inline const char* compressionName(Compression c) {
+    switch (c) {
+        case Compression::Gzip: return "gzip";
+        case Compression::Xz: return "xz";
+        case Compression::Zstd: return "zstd";
+        default: return "plain";
+    }
+}
+
+// Whether this build links the library for it
+inline bool canDecompress(Compression c) {
+    switch (c) {
+        case Compression::None: return true;
+#ifdef RSV_HAVE_ZLIB
+        case Compression::Gzip: return true;
+#endif
+#ifdef RSV_HAVE_LZMA
+        case Compression::Xz: return true;
+#endif
+#ifdef RSV_HAVE_ZSTD
+        case Compression::Zstd: return true;
+#endif
+        default: return false;
+    }
+}
+
+// Random access to the content of a log file, decompressed on the fly when
+// the file is compressed. Sequential reads are the cheap case; one instance
+// per thread.
+class LogFile {
+public:
+    virtual ~LogFile() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    LogFile(const LogFile&) = delete;
+    LogFile& operator=(const LogFile&) = delete;
+
+    // Opens plain and compressed files alike; nullptr (and *error) on failure
+    static std::unique_ptr<LogFile> open(const std::string& path, std::string* error = nullptr);
+
+    // Up to n bytes of content at offset; fewer only at the end of the content
+    virtual size_t read(char* dst, size_t n, uint64_t offset) = 0;
+    // Bytes of the file on disk behind what was read so far (progress of a pass)
+    virtual uint64_t consumed() const = 0;
+
+    Compression compression() const { return compression_; }
+    uint64_t diskSize() const { return disk_size_; }
+
+protected:
+    LogFile(int fd, const struct stat& st, Compression compression)
+        : fd_(fd), disk_size_((uint64_t)st.st_size), compression_(compression) {}
+
+    int fd_;
+    uint64_t disk_size_;
+    Compression compression_;
+};
+
+class PlainLogFile : public LogFile {
+public:
+    PlainLogFile(int fd, const struct stat& st) : LogFile(fd, st, Compression::None) {}
+
+    size_t read(char* dst, size_t n, uint64_t offset) override {
+        size_t r = preadFull(fd_, dst, n, offset);
+        consumed_ = offset + r;
+        return r;
+    }
+    uint64_t consumed() const override { return consumed_; }
+
+private:
+    uint64_t consumed_ = 0;
+};
+
+// Restart points of a compressed file, shared by every reader of it: the
+// first sequential pass records one every `span` bytes of content, later
+// reads resume from the nearest one instead of decompressing from the start.
+// The span doubles whenever the table is full, so memory stays bounded.
+class CheckpointTable {
+public:
+    static constexpr uint64_t MIN_SPAN = 1 << 20;
+    static constexpr size_t MAX_CHECKPOINTS = 512;
+    static constexpr size_t REGISTRY_SIZE = 8;
+
+    struct Checkpoint {
+        uint64_t out = 0;                   // Content offset
+        uint64_t in = 0;                    // File offset of the next compressed byte
+        int bits = 0;                       // Gzip: bits of byte in - 1 not consumed yet
+        std::vector<unsigned char> window;  // Gzip: last 32 KiB of content, deflated
+    };
+    using Ptr = std::shared_ptr<const Checkpoint>;
+
+    // Process-wide table of a file; a replaced or rewritten file gets a new one
+    static std::shared_ptr<CheckpointTable> forFile(const std::string& path, const struct stat& st) {
+        static std::mutex mutex;
+        static std::list<std::pair<std::string, std::shared_ptr<CheckpointTable>>> recent;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = recent.begin(); it != recent.end(); ++it) {
+            if (it->first != path) continue;
+            auto& t = *it->second;
+            if (t.ino_ == st.st_ino && t.dev_ == st.st_dev && t.size_ == (uint64_t)st.st_size &&
+                t.mtime_ == st.st_mtime) {
+                recent.splice(recent.begin(), recent, it);
+                return recent.front().second;
+            }
+            recent.erase(it);
+            break;
+        }
+        auto table = std::make_shared<CheckpointTable>();
+        table->ino_ = st.st_ino;
+        table->dev_ = st.st_dev;
+        table->size_ = (uint64_t)st.st_size;
+        table->mtime_ = st.st_mtime;
+        recent.emplace_front(path, table);
+        if (recent.size() > REGISTRY_SIZE) recent.pop_back();
+        return table;
+    }
+
+    // Whether a checkpoint at this content offset would be kept
+    bool wants(uint64_t out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return out >= next_;
+    }
+
+    void add(Ptr cp) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cp->out < next_) return;
+        points_.push_back(std::move(cp));
+        if (points_.size() > MAX_CHECKPOINTS) {
+            std::vector<Ptr> kept;
+            for (size_t i = 1; i < points_.size(); i += 2) kept.push_back(points_[i]);
+            points_.swap(kept);
+            span_ *= 2;
+        }
+        next_ = points_.back()->out + span_;
+    }
+
+    // Last checkpoint at or before a content offset; nullptr means the start
+    Ptr find(uint64_t out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::upper_bound(points_.begin(), points_.end(), out,
+                                   [](uint64_t o, const Ptr& cp) { return o < cp->out; });
+        return it == points_.begin() ? nullptr : *(it - 1);
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Ptr> points_;
+    uint64_t span_ = MIN_SPAN;
+    uint64_t next_ = MIN_SPAN;
+
+    ino_t ino_ = 0;
+    dev_t dev_ = 0;
+    uint64_t size_ = 0;
+    time_t mtime_ = 0;
+};
+
+// Seeking on top of a sequential decoder: restart from the best restart point
+// before the offset (unless already there or close behind), then decode and
+// drop bytes up to it.
+class CompressedLogFile : public LogFile {
+public:
+    static constexpr size_t INPUT_SIZE = 256 << 10;
+
+    size_t read(char* dst, size_t n, uint64_t offset) override {
+        if (offset < out_ || restartPoint(offset) > out_) {
+            if (!restart(offset)) return 0;
+        }
+        while (out_ < offset) {
+            if (decode(skip_.data(), (size_t)std::min<uint64_t>(skip_.size(), offset - out_)) == 0) return 0;
+        }
+        size_t done = 0;
+        while (done < n) {
+            size_t k = decode(dst + done, n - done);
+            if (k == 0) break;
+            done += k;
+        }
+        return done;
+    }
+
+protected:
+    CompressedLogFile(int fd, const struct stat& st, Compression compression)
+        : LogFile(fd, st, compression), input_(INPUT_SIZE), skip_(64 << 10) {}
+
+    // Content offset restart(offset) would resume from
+    virtual uint64_t restartPoint(uint64_t offset) const = 0;
+    // Reposition the decoder at restartPoint(offset)
+    virtual bool restart(uint64_t offset) = 0;
+    // Next content bytes, advancing out_; 0 at the end of the content or on corrupt data
+    virtual size_t decode(char* dst, size_t n) = 0;
+
+    // Next block of compressed input at in_pos_
+    size_t refill() {
+        size_t n = preadFull(fd_, reinterpret_cast<char*>(input_.data()), input_.size(), in_pos_);
+        in_pos_ += n;
+        return n;
+    }
+
+    std::vector<unsigned char> input_;
+    uint64_t in_pos_ = 0;  // File offset just past the input read so far
+    uint64_t out_ = 0;     // Content offset of the next decoded byte
+
+private:
+    std::vector<char> skip_;
+};
+
+#ifdef RSV_HAVE_ZLIB
+// Gzip (multi-member too, as written by pigz or cat). Checkpoints sit on
+// deflate block boundaries and carry the last 32 KiB of content, the history
+// the next blocks may refer to.
+class GzipLogFile : public CompressedLogFile {
+public:
+    static constexpr size_t WINDOW = 32 << 10;
+
+    GzipLogFile(int fd, const struct stat& st, std::shared_ptr<CheckpointTable> table)
+        : CompressedLogFile(fd, st, Compression::Gzip), table_(std::move(table)), history_(WINDOW) {
+        ok_ = inflateInit2(&strm_, 15 + 16) == Z_OK;
+    }
+
+    ~GzipLogFile() override {
+        if (ok_) inflateEnd(&strm_);
+    }
+
+    uint64_t consumed() const override { return in_pos_ - strm_.avail_in; }
+
+protected:
+    uint64_t restartPoint(uint64_t offset) const override {
+        auto cp = table_->find(offset);
+        return cp ? cp->out : 0;
+    }
+
+    bool restart(uint64_t offset) override {
+        if (!ok_) return false;
+        auto cp = table_->find(offset);
+        strm_.avail_in = 0;
+        trailer_ = 0;
+        history_len_ = history_pos_ = 0;
+        if (!cp) {
+            in_pos_ = out_ = 0;
+            raw_ = false;
+            return inflateReset2(&strm_, 15 + 16) == Z_OK;
+        }
+
+        // Raw deflate from the middle of the stream, primed with the partial byte and the history
+        if (inflateReset2(&strm_, -15) != Z_OK) return false;
+        raw_ = true;
+        in_pos_ = cp->in;
+        if (cp->bits) {
+            char byte;
+            if (preadFull(fd_, &byte, 1, cp->in - 1) != 1) return false;
+            inflatePrime(&strm_, cp->bits, (unsigned char)byte >> (8 - cp->bits));
+        }
+        uLongf length = WINDOW;
+        if (uncompress(history_.data(), &length, cp->window.data(), (uLong)cp->window.size()) != Z_OK) return false;
+        inflateSetDictionary(&strm_, history_.data(), (uInt)length);
+        history_len_ = length;
+        history_pos_ = length % WINDOW;
+        out_ = cp->out;
+        return true;
+    }
+
+    size_t decode(char* dst, size_t n) override {
+        if (!ok_) return 0;
+        strm_.next_out = reinterpret_cast<Bytef*>(dst);
+        strm_.avail_out = (uInt)std::min<size_t>(n, 1u << 30);
+        const uInt wanted = strm_.avail_out;
+
+        while (strm_.avail_out > 0) {
+            if (strm_.avail_in == 0) {
+                size_t r = refill();
+                if (r == 0) break;
+                strm_.next_in = input_.data();
+                strm_.avail_in = (uInt)r;
+            }
+            // A member restarted in raw mode ends before its 8-byte trailer
+            if (trailer_ > 0) {
+                uInt k = std::min<uInt>(trailer_, strm_.avail_in);
+                strm_.next_in += k;
+                strm_.avail_in -= k;
+                trailer_ -= k;
+                if (trailer_ == 0) {
+                    inflateReset2(&strm_, 15 + 16);
+                    raw_ = false;
+                }
+                continue;
+            }
+
+            Bytef* before = strm_.next_out;
+            int ret = inflate(&strm_, Z_BLOCK);
+            remember(before, (size_t)(strm_.next_out - before));
+            out_ += (uint64_t)(strm_.next_out - before);
+
+            if (ret == Z_STREAM_END) {
+                // Another member may follow
+                if (raw_) trailer_ = 8;
+                else inflateReset(&strm_);
+                continue;
+            }
+            if (ret != Z_OK) break;  // Corrupt data or trailing garbage: end of the content
+            bool block_end = (strm_.data_type & 128) && !(strm_.data_type & 64);
+            if (block_end && table_->wants(out_)) checkpoint();
+        }
+        return wanted - strm_.avail_out;
+    }
+
+private:
+    // Keep the last WINDOW bytes of content in a ring
+    void remember(const Bytef* data, size_t n) {
+        if (n >= WINDOW) {
+            std::memcpy(history_.data(), data + n - WINDOW, WINDOW);
+            history_pos_ = 0;
+            history_len_ = WINDOW;
+            return;
+        }
+        size_t first = std::min(n, WINDOW - history_pos_);
+        std::memcpy(history_.data() + history_pos_, data, first);
+        std::memcpy(history_.data(), data + first, n - first);
+        history_pos_ = (history_pos_ + n) % WINDOW;
+        history_len_ = std::min(WINDOW, history_len_ + n);
+    }
+
+    void checkpoint() {
+        std::vector<Bytef> window(history_len_);
+        size_t start = history_len_ < WINDOW ? 0 : history_pos_;
+        size_t first = std::min(history_len_, WINDOW - start);
+        std::memcpy(window.data(), history_.data() + start, first);
+        std::memcpy(window.data() + first, history_.data(), history_len_ - first);
+
+        auto cp = std::make_shared<CheckpointTable::Checkpoint>();
+        cp->out = out_;
+        cp->in = in_pos_ - strm_.avail_in;
+        cp->bits = strm_.data_type & 7;
+        uLongf length = compressBound((uLong)window.size());
+        cp->window.resize(length);
+        if (compress2(cp->window.data(), &length, window.data(), (uLong)window.size(), Z_BEST_SPEED) != Z_OK) return;
+        cp->window.resize(length);
+        table_->add(std::move(cp));
+    }
+
+    std::shared_ptr<CheckpointTable> table_;
+    z_stream strm_{};
+    bool ok_ = false;
+    bool raw_ = false;   // Restarted from a checkpoint: no gzip header/trailer parsing
+    uInt trailer_ = 0;   // Trailer bytes left to skip
+    std::vector<Bytef> history_;
+    size_t history_pos_ = 0;
+    size_t history_len_ = 0;
+};
+#endif
+
+#ifdef RSV_HAVE_ZSTD
+// Zstandard. Decoding can only resume at a frame boundary, so files written as
+// many frames (pzstd, --rsyncable streams, seekable format) seek cheaply and a
+// single-frame file restarts from its beginning.
+class ZstdLogFile : public CompressedLogFile {
+public:
+    ZstdLogFile(int fd, const struct stat& st, std::shared_ptr<CheckpointTable> table)
+        : CompressedLogFile(fd, st, Compression::Zstd), table_(std::move(table)), dctx_(ZSTD_createDCtx()) {
+        // Accept long-distance (--long) windows
+        if (dctx_) ZSTD_DCtx_setParameter(dctx_, ZSTD_d_windowLogMax, 31);
+    }
+
+    ~ZstdLogFile() override { ZSTD_freeDCtx(dctx_); }
+
+    uint64_t consumed() const override { return in_pos_ - (in_.size - in_.pos); }
+
+protected:
+    uint64_t restartPoint(uint64_t offset) const override {
+        auto cp = table_->find(offset);
+        return cp ? cp->out : 0;
+    }
+
+    bool restart(uint64_t offset) override {
+        if (!dctx_) return false;
+        auto cp = table_->find(offset);
+        ZSTD_DCtx_reset(dctx_, ZSTD_reset_session_only);
+        in_ = {input_.data(), 0, 0};
+        in_pos_ = cp ? cp->in : 0;
+        out_ = cp ? cp->out : 0;
+        return true;
+    }
+
+    size_t decode(char* dst, size_t n) override {
+        if (!dctx_) return 0;
+        ZSTD_outBuffer out = {dst, n, 0};
+        while (out.pos < out.size) {
+            if (in_.pos == in_.size) {
+                size_t r = refill();
+                if (r == 0) break;
+                in_ = {input_.data(), r, 0};
+            }
+            size_t before = out.pos;
+            size_t ret = ZSTD_decompressStream(dctx_, &out, &in_);
+            out_ += out.pos - before;
+            if (ZSTD_isError(ret)) break;
+            // 0: a frame ended and is fully flushed
+            if (ret == 0 && table_->wants(out_)) {
+                auto cp = std::make_shared<CheckpointTable::Checkpoint>();
+                cp->out = out_;
+                cp->in = consumed();
+                table_->add(std::move(cp));
+            }
+        }
+        return out.pos;
+    }
+
+private:
+    std::shared_ptr<CheckpointTable> table_;
+    ZSTD_DCtx* dctx_;
+    ZSTD_inBuffer in_ = {nullptr, 0, 0};
+};
+#endif
+
+#ifdef RSV_HAVE_LZMA
+// xz. The file's own index lists its blocks, so seeking is free of any first
+// pass: decoding resumes at the block holding the offset. Multi-threaded xz
+// (the default since xz 5.4) writes many blocks; a single-block file restarts
+// from its beginning.
+class XzLogFile : public CompressedLogFile {
+public:
+    XzLogFile(int fd, const struct stat& st) : CompressedLogFile(fd, st, Compression::Xz) {}
+
+    ~XzLogFile() override { lzma_end(&strm_); }
+
+    // Read the block list from the index at the end of the file
+    bool readIndex() {
+        lzma_stream s = LZMA_STREAM_INIT;
+        lzma_index* index = nullptr;
+        if (lzma_file_info_decoder(&s, &index, UINT64_MAX, disk_size_) != LZMA_OK) return false;
+
+        uint64_t pos = 0;
+        lzma_ret ret = LZMA_OK;
+        while (ret == LZMA_OK) {
+            if (s.avail_in == 0) {
+                size_t n = preadFull(fd_, reinterpret_cast<char*>(input_.data()), input_.size(), pos);
+                if (n == 0) break;
+                pos += n;
+                s.next_in = input_.data();
+                s.avail_in = n;
+            }
+            ret = lzma_code(&s, LZMA_RUN);
+            if (ret == LZMA_SEEK_NEEDED) {
+                pos = s.seek_pos;
+                s.avail_in = 0;
+                ret = LZMA_OK;
+            }
+        }
+        lzma_end(&s);
+        if (ret != LZMA_STREAM_END) {
+            if (index) lzma_index_end(index, nullptr);
+            return false;
+        }
+
+        lzma_index_iter it;
+        lzma_index_iter_init(&it, index);
+        while (!lzma_index_iter_next(&it, LZMA_INDEX_ITER_NONEMPTY_BLOCK)) {
+            blocks_.push_back({it.block.uncompressed_file_offset, it.block.compressed_file_offset,
+                               it.block.unpadded_size, it.stream.flags->check});
+        }
+        lzma_index_end(index, nullptr);
+        return true;
+    }
+
+    uint64_t consumed() const override { return in_pos_ - strm_.avail_in; }
+
+protected:
+    uint64_t restartPoint(uint64_t offset) const override {
+        return blocks_.empty() ? 0 : blocks_[blockOf(offset)].out;
+    }
+
+    bool restart(uint64_t offset) override {
+        if (blocks_.empty()) return false;
+        block_ = blockOf(offset);
+        active_ = false;
+        out_ = blocks_[block_].out;
+        return true;
+    }
+
+    size_t decode(char* dst, size_t n) override {
+        strm_.next_out = reinterpret_cast<uint8_t*>(dst);
+        strm_.avail_out = n;
+        while (strm_.avail_out > 0) {
+            if (!active_ && (block_ >= blocks_.size() || !openBlock())) break;
+            if (strm_.avail_in == 0) {
+                size_t r = refill();
+                if (r == 0) break;
+                strm_.next_in = input_.data();
+                strm_.avail_in = r;
+            }
+            uint8_t* before = strm_.next_out;
+            lzma_ret ret = lzma_code(&strm_, LZMA_RUN);
+            out_ += (uint64_t)(strm_.next_out - before);
+            if (ret == LZMA_STREAM_END) {
+                active_ = false;
+                block_++;
+            } else if (ret != LZMA_OK) {
+                break;
+            }
+        }
+        return n - strm_.avail_out;
+    }
+
+private:
+    struct Block {
+        uint64_t out;       // Content offset
+        uint64_t in;        // File offset of the block header
+        uint64_t unpadded;  // Header + compressed data + check
+        lzma_check check;
+    };
+
+    size_t blockOf(uint64_t offset) const {
+        auto it = std::upper_bound(blocks_.begin(), blocks_.end(), offset,
+                                   [](uint64_t o, const Block& b) { return o < b.out; });
+        return it == blocks_.begin() ? 0 : (size_t)(it - blocks_.begin() - 1);
+    }
+
+    bool openBlock() {
+        const Block& b = blocks_[block_];
+        uint8_t header[LZMA_BLOCK_HEADER_SIZE_MAX];
+        if (preadFull(fd_, reinterpret_cast<char*>(header), 1, b.in) != 1) return false;
+
+        lzma_filter filters[LZMA_FILTERS_MAX + 1];
+        lzma_block block{};
+        block.version = 0;
+        block.check = b.check;
+        block.filters = filters;
+        block.header_size = lzma_block_header_size_decode(header[0]);
+        size_t rest = block.header_size - 1;
+        if (preadFull(fd_, reinterpret_cast<char*>(header) + 1, rest, b.in + 1) != rest) return false;
+        if (lzma_block_header_decode(&block, nullptr, header) != LZMA_OK) return false;
+
+        bool ok = lzma_block_compressed_size(&block, b.unpadded) == LZMA_OK &&
+                  lzma_block_decoder(&strm_, &block) == LZMA_OK;
+        lzma_filters_free(filters, nullptr);
+        if (!ok) return false;
+
+        in_pos_ = b.in + block.header_size;
+        strm_.avail_in = 0;
+        active_ = true;
+        return true;
+    }
+
+    lzma_stream strm_ = LZMA_STREAM_INIT;
+    std::vector<Block> blocks_;
+    size_t block_ = 0;
+    bool active_ = false;  // strm_ is decoding blocks_[block_]
+};
+#endif
+
+inline std::unique_ptr<LogFile> LogFile::open(const std::string& path, std::string* error) {
+    auto fail = [&](const std::string& message) -> std::unique_ptr<LogFile> {
+        if (error) *error = message;
+        return nullptr;
+    };
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return fail(std::strerror(errno));
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        std::string message = std::strerror(errno);
+        ::close(fd);
+        return fail(message);
+    }
+
+    Compression compression = detectCompression(fd);
+    switch (compression) {
+        case Compression::None:
+            return std::make_unique<PlainLogFile>(fd, st);
+#ifdef RSV_HAVE_ZLIB
+        case Compression::Gzip:
+            return std::make_unique<GzipLogFile>(fd, st, CheckpointTable::forFile(path, st));
+#endif
+#ifdef RSV_HAVE_ZSTD
+        case Compression::Zstd:
+            return std::make_unique<ZstdLogFile>(fd, st, CheckpointTable::forFile(path, st));
+#endif
+#ifdef RSV_HAVE_LZMA
+        case Compression::Xz: {
+            auto file = std::make_unique<XzLogFile>(fd, st);
+            if (!file->readIndex()) return fail("corrupt xz index");
+            return file;
+        }
+#endif
+        default:
+            ::close(fd);
+            return fail(std::string("built without ") + compressionName(compression) + " support");
+    }
+}
+
+}
@@ -0,0 +1,262 @@
+#pragma once
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "log_reader.hpp"
+
+namespace api {
+
+// Fixed-capacity ring of lines; once full, each push drops the oldest line.
+// Lines are classified once, when pushed.
+class LineRing {
+public:
+    explicit LineRing(size_t capacity)
+        : lines_(std::max<size_t>(1, capacity)), tags_(lines_.size(), 0) {}
+
+    void push(std::string line) {
+        size_t slot = (head_ + size_) % lines_.size();
+        tags_[slot] = (uint8_t)logPatterns().scan(line);
+        lines_[slot] = std::move(line);
+        if (size_ < lines_.size()) size_++;
+        else head_ = (head_ + 1) % lines_.size();
+    }
+
+    // 0 is the oldest line still held
+    const std::string& operator[](size_t i) const { return lines_[(head_ + i) % lines_.size()]; }
+    uint32_t tags(size_t i) const { return tags_[(head_ + i) % lines_.size()]; }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return lines_.size(); }
+
+private:
+    std::vector<std::string> lines_;
+    std::vector<uint8_t> tags_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+// tail -f for one file. A watcher thread wakes on inotify events, or every
+// POLL_INTERVAL when none arrive (Lustre/GPFS/NFS writes made on compute nodes
+// never raise inotify on the login node), reads only the bytes appended since
+// the last offset and pushes complete lines into a bounded ring.
+// Truncation restarts from offset 0; rotation (new inode at the path) reopens.
+class LogFollower : public LineSource {
+public:
+    static constexpr auto POLL_INTERVAL = std::chrono::milliseconds(1000);
+    // Coalesces bursts of writes into one redraw
+    static constexpr auto MIN_UPDATE_INTERVAL = std::chrono::milliseconds(50);
+    // Larger jumps between two checks only keep their tail
+    static constexpr uint64_t MAX_CATCHUP_BYTES = 16 << 20;
+
+    LogFollower(std::string path, size_t capacity, std::function<void()> on_update)
+        : path_(std::move(path)), ring_(capacity), on_update_(std::move(on_update)) {}
+
+    ~LogFollower() { stop(); }
+
+    LogFollower(const LogFollower&) = delete;
+    LogFollower& operator=(const LogFollower&) = delete;
+
+    // Seed the ring with the current tail, then watch for appends
+    bool start() {
+        if (running_) return true;
+        fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) return false;
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) {
+            closeFile();
+            return false;
+        }
+        ino_ = st.st_ino;
+        dev_ = st.st_dev;
+
+        auto tail = LogTail::read(path_, ring_.capacity());
+        const auto& lines = tail.lines();
+        uint64_t end = tail.startOffset();
+        for (auto line : lines) end += line.size() + 1;
+
+        // The last line has no newline yet: it stays pending as the partial line
+        size_t complete = lines.size();
+        if (end > tail.fileSize() && complete > 0) partial_ = std::string(lines[--complete]);
+        for (size_t i = 0; i < complete; ++i) ring_.push(std::string(lines[i]));
+        offset_ = tail.fileSize();
+
+        if (::pipe2(wake_, O_CLOEXEC) != 0) {
+            closeFile();
+            return false;
+        }
+        running_ = true;
+        thread_ = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop() {
+        if (!running_) return;
+        running_ = false;
+        char c = 0;
+        (void)!::write(wake_[1], &c, 1);
+        thread_.join();
+        ::close(wake_[0]);
+        ::close(wake_[1]);
+        closeFile();
+    }
+
+    bool running() const { return running_; }
+    const std::string& path() const { return path_; }
+
+    // Complete lines plus the pending partial line, if any
+    size_t lineCount() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ring_.size() + (partial_.empty() ? 0 : 1);
+    }
+
+    // Lines [first, first + count), visited under the lock
+    void visit(size_t first, size_t count, const Visitor& f) const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t total = ring_.size() + (partial_.empty() ? 0 : 1);
+        size_t end = std::min(total, first + count);
+        for (size_t i = first; i < end; ++i) {
+            f(i, i < ring_.size() ? std::string_view(ring_[i]) : std::string_view(partial_));
+        }
+    }
+
+    uint32_t rangeTags(size_t begin, size_t end) const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t tags = 0;
+        for (size_t i = begin; i < std::min(end, ring_.size()); ++i) tags |= ring_.tags(i);
+        if (!partial_.empty() && begin <= ring_.size() && ring_.size() < end) tags |= logPatterns().scan(partial_);
+        return tags;
+    }
+
+private:
+    void run() {
+        int in = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        constexpr uint32_t mask = IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF;
+        int wd = in >= 0 ? ::inotify_add_watch(in, path_.c_str(), mask) : -1;
+
+        while (running_) {
+            pollfd fds[2] = {{wake_[0], POLLIN, 0}, {in, POLLIN, 0}};
+            ::poll(fds, wd >= 0 ? 2 : 1, (int)POLL_INTERVAL.count());
+            if (!running_) break;
+
+            if (wd >= 0 && (fds[1].revents & POLLIN)) {
+                char events[4096];
+                while (::read(in, events, sizeof(events)) > 0) {}
+            }
+
+            bool reopened = false;
+            if (readAppended(reopened)) {
+                if (on_update_) on_update_();
+                std::this_thread::sleep_for(MIN_UPDATE_INTERVAL);
+            }
+            if (reopened && in >= 0) {
+                if (wd >= 0) ::inotify_rm_watch(in, wd);
+                wd = ::inotify_add_watch(in, path_.c_str(), mask);
+            }
+        }
+        if (in >= 0) ::close(in);
+    }
+
+    // Returns true when lines changed
+    bool readAppended(bool& reopened) {
+        bool changed = false;
+
+        struct stat st;
+        if (::stat(path_.c_str(), &st) == 0 && (st.st_ino != ino_ || st.st_dev != dev_)) {
+            int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd >= 0) {
+                closeFile();
+                fd_ = fd;
+                ino_ = st.st_ino;
+                dev_ = st.st_dev;
+                offset_ = 0;
+                reopened = true;
+                pushMarker("[log rotated: " + path_ + "]");
+                changed = true;
+            }
+        }
+
+        if (fd_ < 0 || ::fstat(fd_, &st) != 0) return changed;
+        uint64_t size = (uint64_t)st.st_size;
+        if (size < offset_) {
+            offset_ = 0;
+            pushMarker("[log truncated]");
+            changed = true;
+        }
+        if (size == offset_) return changed;
+
+        bool skipped = false;
+        if (size - offset_ > MAX_CATCHUP_BYTES) {
+            offset_ = size - MAX_CATCHUP_BYTES;
+            skipped = true;
+        }
+
+        std::vector<char> chunk((size_t)(size - offset_));
+        size_t n = preadFull(fd_, chunk.data(), chunk.size(), offset_);
+        offset_ += n;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        const char* p = chunk.data();
+        const char* end = p + n;
+        if (skipped) {
+            // Resume at the next line boundary
+            partial_.clear();
+            auto* nl = static_cast<const char*>(std::memchr(p, '\n', n));
+            p = nl ? nl + 1 : end;
+        }
+        while (p < end) {
+            auto* nl = static_cast<const char*>(std::memchr(p, '\n', (size_t)(end - p)));
+            if (!nl) {
+                partial_.append(p, end);
+                break;
+            }
+            partial_.append(p, nl);
+            ring_.push(std::move(partial_));
+            partial_.clear();
+            p = nl + 1;
+        }
+        return true;
+    }
+
+    void pushMarker(std::string text) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!partial_.empty()) {
+            ring_.push(std::move(partial_));
+            partial_.clear();
+        }
+        ring_.push(std::move(text));
+    }
+
+    void closeFile() {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+    std::string path_;
+    int fd_ = -1;
+    ino_t ino_ = 0;
+    dev_t dev_ = 0;
+    uint64_t offset_ = 0;
+    int wake_[2] = {-1, -1};
+
+    mutable std::mutex mutex_;
+    LineRing ring_;
+    std::string partial_;
+
+    std::function<void()> on_update_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+}
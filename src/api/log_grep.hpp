@@ -0,0 +1,310 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "log_file.hpp"
+#include "text_search.hpp"
+
+namespace api {
+
+// Fixed-string grep over many log files at once (every task of an array).
+// Files are spread over a work-stealing pool: each worker drains its own
+// queue, then takes files from the back of the others', so a few large logs
+// do not leave the rest of the pool idle. At most io_limit reads (opens
+// included) are in flight at any time, to spare the parallel filesystem;
+// scanning with findAll() happens outside that limit. Hits are published as
+// each block is scanned, one per matching line.
+class LogGrep {
+public:
+    struct File {
+        std::string label;
+        std::string path;
+    };
+
+    struct Hit {
+        uint64_t line;        // 0-based
+        std::string excerpt;  // Part of the line around the match
+    };
+
+    enum class FileState : uint8_t { Queued, Scanning, Done, Missing };
+
+    static constexpr size_t BLOCK_SIZE = 1 << 20;
+    static constexpr size_t DEFAULT_IO_LIMIT = 8;
+    // Hits kept per file; the rest are only counted
+    static constexpr size_t MAX_HITS_PER_FILE = 1000;
+    static constexpr size_t MAX_EXCERPT = 200;
+    // A line longer than this is scanned in pieces
+    static constexpr size_t MAX_LINE = 16 << 20;
+    static constexpr auto PROGRESS_INTERVAL = std::chrono::milliseconds(100);
+
+    LogGrep(std::vector<File> files, std::string needle, size_t io_limit = DEFAULT_IO_LIMIT,
+            std::function<void()> on_progress = {})
+        : files_(std::move(files)), needle_(std::move(needle)), io_limit_(std::max<size_t>(1, io_limit)),
+          on_progress_(std::move(on_progress)), state_(files_.size(), FileState::Queued),
+          hits_(files_.size()), matches_(files_.size(), 0) {
+        if (needle_.empty() || files_.empty()) return;
+
+        size_t workers = std::max(1u, std::thread::hardware_concurrency());
+        workers = std::min(workers, files_.size());
+        for (size_t w = 0; w < workers; ++w) queues_.push_back(std::make_unique<Queue>());
+        for (size_t i = 0; i < files_.size(); ++i) queues_[i % workers]->files.push_back((uint32_t)i);
+
+        running_ = workers;
+        for (size_t w = 0; w < workers; ++w) threads_.emplace_back([this, w] { work(w); });
+    }
+
+    ~LogGrep() {
+        stop_ = true;
+        io_cv_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+
+    LogGrep(const LogGrep&) = delete;
+    LogGrep& operator=(const LogGrep&) = delete;
+
+    const std::vector<File>& files() const { return files_; }
+    const std::string& needle() const { return needle_; }
+    bool done() const { return running_ == 0; }
+    size_t filesDone() const { return files_done_; }
+
+    FileState state(size_t file) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return state_[file];
+    }
+
+    // Matching lines of a file, stored or not
+    uint64_t matchCount(size_t file) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return matches_[file];
+    }
+
+    size_t filesMatched() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (size_t)std::count_if(matches_.begin(), matches_.end(), [](uint64_t m) { return m > 0; });
+    }
+
+    size_t missingCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (size_t)std::count(state_.begin(), state_.end(), FileState::Missing);
+    }
+
+    // Stored hits, ordered by file then line
+    size_t hitCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refreshRows();
+        return rows_before_.back();
+    }
+
+    // Row of the first hit at or after (file, line)
+    size_t rowOf(size_t file, uint64_t line) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refreshRows();
+        const auto& h = hits_[file];
+        auto it = std::lower_bound(h.begin(), h.end(), line, [](const Hit& a, uint64_t l) { return a.line < l; });
+        return rows_before_[file] + (size_t)(it - h.begin());
+    }
+
+    // Rows [first, first + count) as (row, file, hit), under the lock
+    template <typename F>
+    void visit(size_t first, size_t count, F&& f) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refreshRows();
+        size_t end = std::min(rows_before_.back(), first + count);
+        if (first >= end) return;
+        size_t file = (size_t)(std::upper_bound(rows_before_.begin(), rows_before_.end(), first) - rows_before_.begin()) - 1;
+        for (size_t row = first; row < end; ++row) {
+            while (row >= rows_before_[file + 1]) file++;
+            f(row, file, hits_[file][row - rows_before_[file]]);
+        }
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<uint32_t> files;
+    };
+
+    // Holds one of the io_limit read slots
+    class IoSlot {
+    public:
+        explicit IoSlot(LogGrep& g) : g_(g) {
+            std::unique_lock<std::mutex> lock(g_.io_mutex_);
+            g_.io_cv_.wait(lock, [&] { return g_.io_busy_ < g_.io_limit_ || g_.stop_; });
+            g_.io_busy_++;
+        }
+        ~IoSlot() {
+            {
+                std::lock_guard<std::mutex> lock(g_.io_mutex_);
+                g_.io_busy_--;
+            }
+            g_.io_cv_.notify_one();
+        }
+
+    private:
+        LogGrep& g_;
+    };
+
+    // Own queue from the front, others' from the back
+    bool next(size_t w, uint32_t& file) {
+        for (size_t k = 0; k < queues_.size(); ++k) {
+            Queue& q = *queues_[(w + k) % queues_.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.files.empty()) continue;
+            if (k == 0) {
+                file = q.files.front();
+                q.files.pop_front();
+            } else {
+                file = q.files.back();
+                q.files.pop_back();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void work(size_t w) {
+        uint32_t file;
+        while (!stop_ && next(w, file)) {
+            grepFile(file);
+            files_done_++;
+            progress(false);
+        }
+        if (--running_ == 0) progress(true);
+    }
+
+    void grepFile(uint32_t index) {
+        setState(index, FileState::Scanning);
+        std::unique_ptr<LogFile> file;
+        {
+            IoSlot slot(*this);
+            if (stop_) return;
+            file = LogFile::open(files_[index].path);
+        }
+        if (!file) {
+            setState(index, FileState::Missing);
+            return;
+        }
+
+        // Whole lines are scanned; the unterminated end of a block is carried over
+        std::vector<char> buffer(BLOCK_SIZE);
+        uint64_t offset = 0;
+        uint64_t line = 0;
+        size_t carry = 0;
+        while (!stop_) {
+            if (buffer.size() < carry + BLOCK_SIZE) buffer.resize(carry + BLOCK_SIZE);
+            size_t n;
+            {
+                IoSlot slot(*this);
+                n = file->read(buffer.data() + carry, BLOCK_SIZE, offset);
+            }
+            offset += n;
+            size_t filled = carry + n;
+            bool eof = n < BLOCK_SIZE;
+
+            size_t end = filled;
+            if (!eof && filled < MAX_LINE) {
+                auto* nl = static_cast<const char*>(memrchr(buffer.data(), '\n', filled));
+                end = nl ? (size_t)(nl - buffer.data()) + 1 : 0;
+            }
+            scan(index, buffer.data(), end, line);
+            std::memmove(buffer.data(), buffer.data() + end, filled - end);
+            carry = filled - end;
+            if (eof) break;
+        }
+        setState(index, FileState::Done);
+    }
+
+    // One hit per matching line; `line` is the number of data[0] and advances past the block
+    void scan(uint32_t index, const char* data, size_t n, uint64_t& line) {
+        std::vector<Hit> found;
+        uint64_t matches = 0;
+        size_t counted = 0;     // Newlines counted in data[0, counted)
+        size_t line_end = 0;    // End of the last matching line
+        findAll(data, n, needle_, [&](size_t pos) {
+            if (pos < line_end) return;
+            line += (uint64_t)std::count(data + counted, data + pos, '\n');
+            counted = pos;
+            auto* nl = static_cast<const char*>(std::memchr(data + pos, '\n', n - pos));
+            line_end = nl ? (size_t)(nl - data) : n;
+            matches++;
+            if (found.size() < MAX_HITS_PER_FILE) found.push_back({line, excerpt(data, pos, line_end)});
+        });
+        line += (uint64_t)std::count(data + counted, data + n, '\n');
+        if (matches == 0) return;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& hits = hits_[index];
+        size_t room = MAX_HITS_PER_FILE - std::min(MAX_HITS_PER_FILE, hits.size());
+        for (size_t i = 0; i < std::min(room, found.size()); ++i) hits.push_back(std::move(found[i]));
+        matches_[index] += matches;
+        version_++;
+    }
+
+    // Up to MAX_EXCERPT bytes of the line, starting a little before the match
+    static std::string excerpt(const char* data, size_t pos, size_t line_end) {
+        auto* nl = pos > 0 ? static_cast<const char*>(memrchr(data, '\n', pos)) : nullptr;
+        size_t start = nl ? (size_t)(nl - data) + 1 : 0;
+        start = std::max(start, pos - std::min<size_t>(pos, 40));
+        size_t end = std::min(line_end, start + MAX_EXCERPT);
+        if (end > start && data[end - 1] == '\r') end--;
+        return std::string(data + start, end - start);
+    }
+
+    void setState(uint32_t index, FileState state) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        state_[index] = state;
+        version_++;
+    }
+
+    void progress(bool last) {
+        if (!on_progress_) return;
+        auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+        auto prev = last_progress_.load();
+        auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(PROGRESS_INTERVAL).count();
+        if (last || (now - prev >= interval && last_progress_.compare_exchange_strong(prev, now))) on_progress_();
+    }
+
+    // Under the lock
+    void refreshRows() const {
+        if (rows_version_ == version_) return;
+        rows_before_.assign(1, 0);
+        for (const auto& h : hits_) rows_before_.push_back(rows_before_.back() + h.size());
+        rows_version_ = version_;
+    }
+
+    std::vector<File> files_;
+    std::string needle_;
+    size_t io_limit_;
+    std::function<void()> on_progress_;
+
+    mutable std::mutex mutex_;
+    std::vector<FileState> state_;
+    std::vector<std::vector<Hit>> hits_;
+    std::vector<uint64_t> matches_;
+    uint64_t version_ = 0;
+    mutable std::vector<size_t> rows_before_{0};  // Rows before each file's hits
+    mutable uint64_t rows_version_ = UINT64_MAX;
+
+    std::mutex io_mutex_;
+    std::condition_variable io_cv_;
+    size_t io_busy_ = 0;
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> running_{0};
+    std::atomic<size_t> files_done_{0};
+    std::atomic<bool> stop_{false};
+    std::atomic<int64_t> last_progress_{0};
+};
+
+}
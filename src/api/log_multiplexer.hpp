@@ -0,0 +1,403 @@
+#pragma once
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "log_follower.hpp"
+#include "log_reader.hpp"
+
+namespace api {
+
+// tail -f over many files at once (the tasks of a job array, a sweep): lines
+// of every source are interleaved in the order they arrive, prefixed with the
+// source label. One thread watches all the files through a single inotify
+// descriptor; on network filesystems, where writes from compute nodes raise
+// no event, each file is stat'ed instead, less often the longer it stays idle.
+// Files are only opened to read what was appended, so hundreds of sources do
+// not hold hundreds of descriptors. Each source keeps its own bounded ring:
+// a chatty task cannot push the lines of the quiet ones out.
+class LogMultiplexer : public LineSource {
+public:
+    struct Source {
+        std::string label;
+        std::string path;
+    };
+
+    static constexpr auto MIN_POLL_INTERVAL = std::chrono::milliseconds(1000);
+    static constexpr auto MAX_POLL_INTERVAL = std::chrono::milliseconds(8000);
+    static constexpr auto MIN_UPDATE_INTERVAL = std::chrono::milliseconds(50);
+    // Lines held over all sources, and at least per source
+    static constexpr size_t TOTAL_LINES = 200000;
+    static constexpr size_t MIN_SOURCE_LINES = 200;
+    // Existing lines shown per source when the view opens
+    static constexpr size_t SEED_LINES = 20;
+    // Larger jumps between two checks of a file only keep their tail
+    static constexpr uint64_t MAX_CATCHUP_BYTES = 1 << 20;
+
+    LogMultiplexer(std::vector<Source> sources, std::function<void()> on_update)
+        : on_update_(std::move(on_update)) {
+        size_t capacity = std::max(MIN_SOURCE_LINES, TOTAL_LINES / std::max<size_t>(1, sources.size()));
+        for (auto& s : sources) {
+            label_width_ = std::max(label_width_, s.label.size());
+            sources_.emplace_back(std::move(s), capacity);
+        }
+    }
+
+    ~LogMultiplexer() { stop(); }
+
+    LogMultiplexer(const LogMultiplexer&) = delete;
+    LogMultiplexer& operator=(const LogMultiplexer&) = delete;
+
+    bool start() {
+        if (running_) return true;
+        if (::pipe2(wake_, O_CLOEXEC) != 0) return false;
+        running_ = true;
+        thread_ = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop() {
+        if (!running_) return;
+        running_ = false;
+        char c = 0;
+        (void)!::write(wake_[1], &c, 1);
+        thread_.join();
+        ::close(wake_[0]);
+        ::close(wake_[1]);
+    }
+
+    size_t sourceCount() const { return sources_.size(); }
+    const std::string& label(size_t i) const { return sources_[i].info.label; }
+    const std::string& path(size_t i) const { return sources_[i].info.path; }
+
+    // Sources that exist on disk, and sources with at least one error line
+    size_t openedCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (size_t)std::count_if(sources_.begin(), sources_.end(), [](const Src& s) { return s.ino != 0; });
+    }
+    size_t failingCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (size_t)std::count_if(sources_.begin(), sources_.end(), [](const Src& s) { return s.errors > 0; });
+    }
+
+    // Lines shown: one source (or all when negative), errors/warnings only
+    void setFilter(int source, bool flagged_only) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        filter_source_ = source;
+        filter_flagged_ = flagged_only;
+        version_++;
+        rebuild_ = true;
+    }
+
+    size_t lineCount() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refreshView();
+        return view_.size();
+    }
+
+    // "label │ text", visited under the lock
+    void visit(size_t first, size_t count, const Visitor& f) const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refreshView();
+        std::string text;
+        size_t end = std::min(view_.size(), first + count);
+        for (size_t i = first; i < end; ++i) {
+            const Src& s = sources_[view_[i].source];
+            text.assign(s.info.label);
+            text.resize(label_width_, ' ');
+            text += " │ ";
+            text += s.ring[(size_t)(view_[i].line - (s.pushed - s.ring.size()))];
+            f(i, text);
+        }
+    }
+
+    uint32_t rangeTags(size_t begin, size_t end) const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refreshView();
+        end = std::min(end, view_.size());
+        if (begin >= end) return 0;
+        return (errors_before_[end] > errors_before_[begin] ? LOG_ERROR : 0) |
+               (warnings_before_[end] > warnings_before_[begin] ? LOG_WARNING : 0);
+    }
+
+private:
+    // A line of a source: its number among the lines the source pushed
+    struct Ref {
+        uint32_t source;
+        uint64_t line;
+    };
+
+    struct Src {
+        Source info;
+        LineRing ring;
+        uint64_t pushed = 0;  // Lines pushed so far; the ring holds the last ones
+        size_t errors = 0;
+        std::string partial;
+        ino_t ino = 0;        // 0 until the file exists
+        dev_t dev = 0;
+        uint64_t offset = 0;
+        int wd = -1;
+        bool ignored = false; // Compressed: a finished job's log
+        std::chrono::milliseconds interval = MIN_POLL_INTERVAL;
+        std::chrono::steady_clock::time_point next_check;
+
+        Src(Source s, size_t capacity) : info(std::move(s)), ring(capacity) {}
+        bool live(uint64_t line) const { return line + ring.size() >= pushed; }
+        uint32_t tags(uint64_t line) const { return ring.tags((size_t)(line - (pushed - ring.size()))); }
+    };
+
+    void run() {
+        int in = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        std::unordered_map<int, size_t> watched;
+        auto watch = [&](size_t i) {
+            constexpr uint32_t mask = IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF;
+            if (in < 0 || sources_[i].wd >= 0) return;
+            sources_[i].wd = ::inotify_add_watch(in, sources_[i].info.path.c_str(), mask);
+            if (sources_[i].wd >= 0) watched[sources_[i].wd] = i;
+        };
+
+        seed();
+        for (size_t i = 0; i < sources_.size() && running_; ++i) {
+            if (!sources_[i].ignored) watch(i);
+        }
+        if (on_update_) on_update_();
+
+        std::vector<char> dirty(sources_.size(), 0);
+        while (running_) {
+            pollfd fds[2] = {{wake_[0], POLLIN, 0}, {in, POLLIN, 0}};
+            ::poll(fds, in >= 0 ? 2 : 1, (int)MIN_POLL_INTERVAL.count());
+            if (!running_) break;
+
+            if (in >= 0 && (fds[1].revents & POLLIN)) {
+                alignas(inotify_event) char events[4096];
+                ssize_t n;
+                while ((n = ::read(in, events, sizeof(events))) > 0) {
+                    for (char* p = events; p < events + n;) {
+                        auto* ev = reinterpret_cast<inotify_event*>(p);
+                        auto it = watched.find(ev->wd);
+                        if (it != watched.end()) {
+                            dirty[it->second] = 1;
+                            // Deleted or moved away: watch the path again once it reappears
+                            if (ev->mask & (IN_IGNORED | IN_MOVE_SELF | IN_DELETE_SELF)) {
+                                if (!(ev->mask & IN_IGNORED)) ::inotify_rm_watch(in, ev->wd);
+                                sources_[it->second].wd = -1;
+                                watched.erase(it);
+                            }
+                        }
+                        p += sizeof(inotify_event) + ev->len;
+                    }
+                }
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            bool changed = false;
+            for (size_t i = 0; i < sources_.size() && running_; ++i) {
+                Src& s = sources_[i];
+                if (s.ignored || (!dirty[i] && now < s.next_check)) continue;
+                dirty[i] = 0;
+                bool grew = readAppended(s, (uint32_t)i);
+                changed |= grew;
+                // Idle files are checked less and less often
+                s.interval = grew ? MIN_POLL_INTERVAL : std::min(MAX_POLL_INTERVAL, s.interval * 2);
+                s.next_check = now + s.interval;
+                if (s.wd < 0 && s.ino != 0) watch(i);
+            }
+
+            if (changed) {
+                if (on_update_) on_update_();
+                std::this_thread::sleep_for(MIN_UPDATE_INTERVAL);
+            }
+        }
+        if (in >= 0) ::close(in);
+    }
+
+    // Last lines of every existing file, oldest files first so the most
+    // recently written ones end up at the bottom
+    void seed() {
+        std::vector<std::pair<time_t, size_t>> order;
+        for (size_t i = 0; i < sources_.size() && running_; ++i) {
+            struct stat st;
+            if (::stat(sources_[i].info.path.c_str(), &st) == 0) order.emplace_back(st.st_mtime, i);
+        }
+        std::stable_sort(order.begin(), order.end());
+
+        for (auto [mtime, i] : order) {
+            if (!running_) return;
+            Src& s = sources_[i];
+            if (detectCompression(s.info.path) != Compression::None) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                push(s, (uint32_t)i, "[compressed log, not followed]");
+                s.ignored = true;
+                continue;
+            }
+
+            auto tail = LogTail::read(s.info.path, SEED_LINES);
+            if (!tail.error().empty()) continue;
+            struct stat st;
+            if (::stat(s.info.path.c_str(), &st) != 0) continue;
+
+            const auto& lines = tail.lines();
+            uint64_t end = tail.startOffset();
+            for (auto line : lines) end += line.size() + 1;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            size_t complete = lines.size();
+            if (end > tail.fileSize() && complete > 0) s.partial = std::string(lines[--complete]);
+            for (size_t k = 0; k < complete; ++k) push(s, (uint32_t)i, std::string(lines[k]));
+            s.ino = st.st_ino;
+            s.dev = st.st_dev;
+            s.offset = tail.fileSize();
+        }
+    }
+
+    // Returns true when lines were added
+    bool readAppended(Src& s, uint32_t index) {
+        struct stat st;
+        if (::stat(s.info.path.c_str(), &st) != 0) return false;  // Not created yet
+
+        bool changed = false;
+        if (st.st_ino != s.ino || st.st_dev != s.dev) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (s.ino != 0) pushMarker(s, index, "[log replaced]");
+            s.ino = st.st_ino;
+            s.dev = st.st_dev;
+            s.offset = 0;
+            changed = s.ino != 0;
+        }
+        uint64_t size = (uint64_t)st.st_size;
+        if (size < s.offset) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pushMarker(s, index, "[log truncated]");
+            s.offset = 0;
+            changed = true;
+        }
+        if (size == s.offset) return changed;
+
+        bool skipped = false;
+        if (size - s.offset > MAX_CATCHUP_BYTES) {
+            s.offset = size - MAX_CATCHUP_BYTES;
+            skipped = true;
+        }
+        int fd = ::open(s.info.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return changed;
+        std::vector<char> chunk((size_t)(size - s.offset));
+        size_t n = preadFull(fd, chunk.data(), chunk.size(), s.offset);
+        ::close(fd);
+        s.offset += n;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        const char* p = chunk.data();
+        const char* end = p + n;
+        if (skipped) {
+            s.partial.clear();
+            auto* nl = static_cast<const char*>(std::memchr(p, '\n', n));
+            p = nl ? nl + 1 : end;
+        }
+        while (p < end) {
+            auto* nl = static_cast<const char*>(std::memchr(p, '\n', (size_t)(end - p)));
+            if (!nl) {
+                s.partial.append(p, end);
+                break;
+            }
+            s.partial.append(p, nl);
+            push(s, index, std::move(s.partial));
+            s.partial.clear();
+            p = nl + 1;
+        }
+        return true;
+    }
+
+    void pushMarker(Src& s, uint32_t index, std::string text) {
+        if (!s.partial.empty()) {
+            push(s, index, std::move(s.partial));
+            s.partial.clear();
+        }
+        push(s, index, std::move(text));
+    }
+
+    // Under the lock
+    void push(Src& s, uint32_t index, std::string line) {
+        if (s.ring.size() == s.ring.capacity()) {
+            evicted_++;
+            dead_++;
+        }
+        s.ring.push(std::move(line));
+        if (s.ring.tags(s.ring.size() - 1) & LOG_ERROR) s.errors++;
+        order_.push_back({index, s.pushed++});
+        version_++;
+
+        // Drop the references to evicted lines once they are the majority
+        if (dead_ > order_.size() / 2 && dead_ > 4096) {
+            order_.erase(std::remove_if(order_.begin(), order_.end(),
+                                        [&](const Ref& r) { return !sources_[r.source].live(r.line); }),
+                         order_.end());
+            dead_ = 0;
+            rebuild_ = true;
+        }
+    }
+
+    // Bring the filtered view up to date; under the lock. Lines only get
+    // appended until a ring evicts one, which forces a rescan.
+    void refreshView() const {
+        if (view_version_ == version_) return;
+        if (rebuild_ || evicted_ != view_evicted_) {
+            view_.clear();
+            errors_before_.assign(1, 0);
+            warnings_before_.assign(1, 0);
+            scanned_ = 0;
+            rebuild_ = false;
+        }
+        for (; scanned_ < order_.size(); ++scanned_) {
+            const Ref& r = order_[scanned_];
+            const Src& s = sources_[r.source];
+            if (!s.live(r.line)) continue;
+            if (filter_source_ >= 0 && r.source != (uint32_t)filter_source_) continue;
+            uint32_t tags = s.tags(r.line);
+            if (filter_flagged_ && !tags) continue;
+            view_.push_back(r);
+            errors_before_.push_back(errors_before_.back() + ((tags & LOG_ERROR) ? 1 : 0));
+            warnings_before_.push_back(warnings_before_.back() + ((tags & LOG_WARNING) ? 1 : 0));
+        }
+        view_evicted_ = evicted_;
+        view_version_ = version_;
+    }
+
+    std::vector<Src> sources_;
+    size_t label_width_ = 0;
+    std::function<void()> on_update_;
+    int wake_[2] = {-1, -1};
+
+    mutable std::mutex mutex_;
+    std::vector<Ref> order_;  // Every line in arrival order, evicted ones until compaction
+    uint64_t evicted_ = 0;    // Lines evicted from the rings so far
+    uint64_t dead_ = 0;       // order_ entries pointing to evicted lines
+    uint64_t version_ = 0;
+    int filter_source_ = -1;
+    bool filter_flagged_ = false;
+
+    mutable bool rebuild_ = true;
+    mutable std::vector<Ref> view_;
+    mutable std::vector<uint32_t> errors_before_{0};  // Prefix counts over view_, for rangeTags
+    mutable std::vector<uint32_t> warnings_before_{0};
+    mutable size_t scanned_ = 0;                      // order_ entries already considered
+    mutable uint64_t view_version_ = UINT64_MAX;
+    mutable uint64_t view_evicted_ = 0;
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+}
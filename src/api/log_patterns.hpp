@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include "aho_corasick.hpp"
+
+namespace api {
+
+// Tag bits of flagged log lines
+constexpr uint32_t LOG_ERROR = 1;
+constexpr uint32_t LOG_WARNING = 2;
+
+// Adds a comma-separated list such as "warn:retrying,error:\bdiverged\b".
+// Each entry is an error unless prefixed with "warn:"; \b on both ends makes
+// it a whole word. Matching is case-insensitive.
+inline void addLogPatterns(AhoCorasick& ac, const std::string& list) {
+    std::istringstream iss(list);
+    std::string entry;
+    while (std::getline(iss, entry, ',')) {
+        uint32_t tag = LOG_ERROR;
+        if (entry.rfind("warn:", 0) == 0) {
+            tag = LOG_WARNING;
+            entry.erase(0, 5);
+        } else if (entry.rfind("error:", 0) == 0) {
+            entry.erase(0, 6);
+        }
+        bool whole_word = entry.size() > 4 && entry.rfind("\\b", 0) == 0 &&
+                          entry.compare(entry.size() - 2, 2, "\\b") == 0;
+        if (whole_word) entry = entry.substr(2, entry.size() - 4);
+        ac.add(entry, tag, whole_word);
+    }
+}
+
+// Process-wide matcher: built-in patterns plus RSV_LOG_PATTERNS, built once
+inline const AhoCorasick& logPatterns() {
+    static const AhoCorasick ac = [] {
+        AhoCorasick ac;
+        addLogPatterns(ac,
+            "error,traceback,exception,fatal,segmentation fault,core dumped,"
+            "cuda out of memory,cuda error,oom-kill,oom_kill,out of memory,"
+            "slurmstepd: error,\\bkilled\\b,\\bnan\\b,"
+            "warn:warn,warn:deprecat,warn:\\binf\\b");
+        if (const char* user = std::getenv("RSV_LOG_PATTERNS")) addLogPatterns(ac, user);
+        ac.build();
+        return ac;
+    }();
+    return ac;
+}
+
+}
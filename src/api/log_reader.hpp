@@ -0,0 +1,180 @@
+#pragma once
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "log_file.hpp"
+#include "log_patterns.hpp"
+
+namespace api {
+
+// Random access to a sequence of lines. Views passed to the visitor are only
+// valid during the call.
+class LineSource {
+public:
+    using Visitor = std::function<void(size_t index, std::string_view line)>;
+
+    virtual ~LineSource() = default;
+    virtual size_t lineCount() const = 0;
+    virtual void visit(size_t first, size_t count, const Visitor& f) const = 0;
+    // LOG_ERROR / LOG_WARNING bits of the lines in [begin, end)
+    virtual uint32_t rangeTags(size_t begin, size_t end) const = 0;
+};
+
+// Last lines of a file, read backwards from EOF. Only the tail is ever read:
+// blocks are pread from the end until enough newlines are found, so the cost
+// depends on the tail length, not on the file size.
+// Lines are views into one owned buffer, hence move-only. Plain files only:
+// a compressed file has no cheap tail, it is read through LogFile.
+class LogTail : public LineSource {
+public:
+    // Large blocks: on Lustre/GPFS each read is a round-trip, latency not bandwidth bound
+    static constexpr size_t BLOCK_SIZE = 1 << 20;
+    static constexpr size_t DEFAULT_MAX_BYTES = 16 << 20;
+
+    LogTail() = default;
+    LogTail(LogTail&&) = default;
+    LogTail& operator=(LogTail&&) = default;
+    LogTail(const LogTail&) = delete;
+    LogTail& operator=(const LogTail&) = delete;
+
+    static LogTail read(const std::string& path, size_t max_lines,
+                        size_t max_bytes = DEFAULT_MAX_BYTES) {
+        LogTail tail;
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            tail.error_ = std::strerror(errno);
+            return tail;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            tail.error_ = std::strerror(errno);
+            ::close(fd);
+            return tail;
+        }
+        tail.file_size_ = (uint64_t)st.st_size;
+        tail.readBackwards(fd, max_lines, max_bytes);
+        ::close(fd);
+        return tail;
+    }
+
+    // Single-line placeholder ("[Empty file]", ...)
+    static LogTail message(const std::string& text) {
+        LogTail tail;
+        tail.buffer_.assign(text.begin(), text.end());
+        tail.lines_.emplace_back(tail.buffer_.data(), tail.buffer_.size());
+        tail.tags_.push_back(0);
+        return tail;
+    }
+
+    const std::vector<std::string_view>& lines() const { return lines_; }
+    size_t size() const { return lines_.size(); }
+    bool empty() const { return lines_.empty(); }
+
+    size_t lineCount() const override { return lines_.size(); }
+    void visit(size_t first, size_t count, const Visitor& f) const override {
+        size_t end = std::min(lines_.size(), first + count);
+        for (size_t i = first; i < end; ++i) f(i, lines_[i]);
+    }
+    uint32_t rangeTags(size_t begin, size_t end) const override {
+        uint32_t tags = 0;
+        for (size_t i = begin; i < std::min(end, tags_.size()); ++i) tags |= tags_[i];
+        return tags;
+    }
+
+    // Non-empty when the file could not be opened
+    const std::string& error() const { return error_; }
+    uint64_t fileSize() const { return file_size_; }
+    // File offset of the first returned line; > 0 means earlier lines exist
+    uint64_t startOffset() const { return start_offset_; }
+
+private:
+    void readBackwards(int fd, size_t max_lines, size_t max_bytes) {
+        if (file_size_ == 0 || max_lines == 0) {
+            start_offset_ = file_size_;
+            return;
+        }
+
+        // The buffer is filled from its end; `filled` bytes at the tail are valid
+        uint64_t pos = file_size_;
+        size_t filled = 0;
+        size_t found = 0;
+        bool found_start = false;
+        bool first_block = true;
+
+        while (pos > 0 && !found_start) {
+            size_t n = (size_t)std::min<uint64_t>(BLOCK_SIZE, pos);
+            n = std::min(n, max_bytes - filled);
+            if (n == 0) break;
+
+            if (buffer_.size() < filled + n) {
+                std::vector<char> grown(std::min(max_bytes, std::max(buffer_.size() * 2, filled + n)));
+                std::memcpy(grown.data() + grown.size() - filled, buffer_.data() + buffer_.size() - filled, filled);
+                buffer_.swap(grown);
+            }
+
+            char* dst = buffer_.data() + buffer_.size() - filled - n;
+            if (preadFull(fd, dst, n, pos - n) != n) break;  // Truncated under us
+
+            // Scan the block backwards; the final newline of the file ends a line, it does not start one
+            const char* end = dst + n;
+            if (first_block && end[-1] == '\n') end--;
+            first_block = false;
+            while (end > dst) {
+                auto* nl = static_cast<const char*>(memrchr(dst, '\n', (size_t)(end - dst)));
+                if (!nl) break;
+                if (++found == max_lines) {
+                    start_offset_ = pos - n + (uint64_t)(nl - dst) + 1;
+                    found_start = true;
+                    break;
+                }
+                end = nl;
+            }
+
+            pos -= n;
+            filled += n;
+        }
+
+        const char* data = buffer_.data() + buffer_.size() - filled;
+        const char* data_end = buffer_.data() + buffer_.size();
+        const char* begin = data;
+        if (found_start) {
+            begin = data + (start_offset_ - pos);
+        } else if (pos > 0) {
+            // Byte cap reached mid-line: drop the partial first line unless it is all we have
+            auto* nl = static_cast<const char*>(std::memchr(data, '\n', filled));
+            if (nl && nl + 1 < data_end) begin = nl + 1;
+            start_offset_ = pos + (uint64_t)(begin - data);
+        } else {
+            start_offset_ = 0;
+        }
+
+        while (begin < data_end) {
+            auto* nl = static_cast<const char*>(std::memchr(begin, '\n', (size_t)(data_end - begin)));
+            const char* line_end = nl ? nl : data_end;
+            lines_.emplace_back(begin, (size_t)(line_end - begin));
+            begin = line_end + 1;
+        }
+
+        // Classified once, at load
+        const auto& patterns = logPatterns();
+        tags_.reserve(lines_.size());
+        for (auto line : lines_) tags_.push_back((uint8_t)patterns.scan(line));
+    }
+
+    std::vector<char> buffer_;
+    std::vector<std::string_view> lines_;
+    std::vector<uint8_t> tags_;
+    std::string error_;
+    uint64_t file_size_ = 0;
+    uint64_t start_offset_ = 0;
+};
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace api {
+
+enum class NodeState : uint8_t {
+    Idle,
+    Mixed,
+    Allocated,
+    Drain,    // DRAINED / DRAINING / +DRAIN
+    Down,     // DOWN / FAIL / not responding
+    Other,    // RESERVED, PLANNED, FUTURE, ...
+};
+
+// Cluster-wide node table in structure-of-arrays layout: one column per field,
+// rows sorted by node class so each class is a contiguous [begin, end) range.
+// Numeric columns are plain contiguous arrays that reductions can vectorize.
+struct NodeTable {
+    std::vector<std::string> names;
+    std::vector<uint16_t> class_id;
+    std::vector<int32_t> cpu_alloc;
+    std::vector<int32_t> cpu_total;
+    std::vector<int32_t> gpu_used;
+    std::vector<int32_t> gpu_total;
+    std::vector<int64_t> mem_alloc;  // MB
+    std::vector<int64_t> mem_total;  // MB
+    std::vector<NodeState> state;
+
+    std::vector<std::string> class_prefixes;  // e.g. "romeo-a"
+    std::vector<uint32_t> class_begin;        // classes + 1 offsets into the rows
+
+    size_t size() const { return names.size(); }
+    size_t classes() const { return class_prefixes.size(); }
+};
+
+// Totals over a range of rows
+struct NodeRangeStats {
+    int64_t cpu_alloc = 0;
+    int64_t cpu_total = 0;
+    int64_t gpu_used = 0;
+    int64_t gpu_total = 0;
+    int64_t mem_alloc = 0;
+    int64_t mem_total = 0;
+    int nodes = 0;
+    int idle = 0;
+    int unavailable = 0;  // Down or drained
+};
+
+// Single pass over contiguous columns, no branches in the loop body so the
+// compiler can vectorize it (2,000+ nodes aggregate in a few microseconds).
+inline NodeRangeStats aggregateNodes(const NodeTable& t, size_t begin, size_t end) {
+    const int32_t* __restrict ca = t.cpu_alloc.data();
+    const int32_t* __restrict ct = t.cpu_total.data();
+    const int32_t* __restrict gu = t.gpu_used.data();
+    const int32_t* __restrict gt = t.gpu_total.data();
+    const int64_t* __restrict ma = t.mem_alloc.data();
+    const int64_t* __restrict mt = t.mem_total.data();
+    const NodeState* __restrict st = t.state.data();
+
+    NodeRangeStats s;
+    int64_t cpu_alloc = 0, cpu_total = 0, gpu_used = 0, gpu_total = 0, mem_alloc = 0, mem_total = 0;
+    int idle = 0, unavailable = 0;
+    for (size_t i = begin; i < end; ++i) {
+        cpu_alloc += ca[i];
+        cpu_total += ct[i];
+        gpu_used += gu[i];
+        gpu_total += gt[i];
+        mem_alloc += ma[i];
+        mem_total += mt[i];
+        idle += st[i] == NodeState::Idle;
+        unavailable += st[i] == NodeState::Drain || st[i] == NodeState::Down;
+    }
+    s.cpu_alloc = cpu_alloc;
+    s.cpu_total = cpu_total;
+    s.gpu_used = gpu_used;
+    s.gpu_total = gpu_total;
+    s.mem_alloc = mem_alloc;
+    s.mem_total = mem_total;
+    s.nodes = (int)(end - begin);
+    s.idle = idle;
+    s.unavailable = unavailable;
+    return s;
+}
+
+inline NodeRangeStats aggregateClass(const NodeTable& t, size_t class_index) {
+    return aggregateNodes(t, t.class_begin[class_index], t.class_begin[class_index + 1]);
+}
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace api {
+
+// Parser stage for large command outputs (sacct/squeue dumps of a whole
+// account can be 100+ MB). The buffer is cut into chunks on line boundaries,
+// each chunk is parsed on its own thread into its own output vector, and the
+// vectors are concatenated in chunk order, so the rows come out as if parsed
+// line by line. Outputs below MIN_CHUNK are parsed on the calling thread.
+namespace parse {
+
+constexpr size_t MIN_CHUNK = 1 << 20;
+// Chunks per thread, so that uneven chunks still keep every core busy
+constexpr size_t CHUNKS_PER_THREAD = 4;
+
+inline size_t defaultThreads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Splits `data` into about `count` chunks ending on newlines. A chunk only
+// starts on a line for which starts_record(line) holds, so that lines that
+// belong together (a sacct job and its steps) stay in one chunk.
+template <typename Pred>
+std::vector<std::string_view> splitLines(std::string_view data, size_t count, Pred&& starts_record) {
+    std::vector<std::string_view> chunks;
+    size_t target = std::max<size_t>(1, data.size() / std::max<size_t>(1, count));
+    size_t begin = 0;
+    while (begin < data.size()) {
+        size_t end = begin + target;
+        while (end < data.size()) {
+            auto* nl = static_cast<const char*>(std::memchr(data.data() + end, '\n', data.size() - end));
+            if (!nl) {
+                end = data.size();
+                break;
+            }
+            end = (size_t)(nl - data.data()) + 1;
+            if (end >= data.size()) break;
+            size_t next = data.find('\n', end);
+            if (starts_record(data.substr(end, next == std::string_view::npos ? std::string_view::npos : next - end))) break;
+        }
+        end = std::min(end, data.size());
+        chunks.push_back(data.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
+// Predicate for outputs of one record per line
+inline bool anyLine(std::string_view) { return true; }
+
+// Calls f(line) for each line of `chunk`, without its '\n' (nor a '\r')
+template <typename F>
+void forEachLine(std::string_view chunk, F&& f) {
+    size_t pos = 0;
+    while (pos < chunk.size()) {
+        size_t nl = chunk.find('\n', pos);
+        size_t end = nl == std::string_view::npos ? chunk.size() : nl;
+        std::string_view line = chunk.substr(pos, end - pos);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        f(line);
+        pos = end + 1;
+    }
+}
+
+// Splits a line on `sep` into `fields` (views into the line), reusing its storage
+inline void splitFields(std::string_view line, char sep, std::vector<std::string_view>& fields) {
+    fields.clear();
+    size_t pos = 0;
+    while (true) {
+        size_t next = line.find(sep, pos);
+        if (next == std::string_view::npos) {
+            fields.push_back(line.substr(pos));
+            return;
+        }
+        fields.push_back(line.substr(pos, next - pos));
+        pos = next + 1;
+    }
+}
+
+// parse_chunk(std::string_view chunk, std::vector<T>& out) appends the rows
+// of a chunk; it runs concurrently on different chunks and outputs. Chunks
+// start on lines for which starts_record(line) holds (anyLine: every line).
+template <typename T, typename F, typename Pred>
+std::vector<T> parallel(std::string_view data, F&& parse_chunk, Pred&& starts_record, size_t threads = 0) {
+    std::vector<T> rows;
+    if (threads == 0) threads = defaultThreads();
+    if (threads == 1 || data.size() < MIN_CHUNK) {
+        parse_chunk(data, rows);
+        return rows;
+    }
+
+    size_t count = std::min(threads * CHUNKS_PER_THREAD, std::max<size_t>(1, data.size() / (MIN_CHUNK / 4)));
+    auto chunks = splitLines(data, count, starts_record);
+    std::vector<std::vector<T>> parsed(chunks.size());
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+        for (size_t i; (i = next++) < chunks.size();) parse_chunk(chunks[i], parsed[i]);
+    };
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < std::min(threads, chunks.size()); ++t) workers.emplace_back(work);
+    work();
+    for (auto& t : workers) t.join();
+
+    size_t total = 0;
+    for (const auto& p : parsed) total += p.size();
+    rows.reserve(total);
+    for (auto& p : parsed) std::move(p.begin(), p.end(), std::back_inserter(rows));
+    return rows;
+}
+
+}
+
+}
@@ -7,6 +7,12 @@
 #include <sstream>
 #include <cstdlib>
 #include <regex>
+#include <map>
+#include <cctype>
+#include <algorithm>
+#include "index_set.hpp"
+#include "parallel_parse.hpp"
+#include "node_table.hpp"
 
 namespace api {
 
@@ -14,12 +20,24 @@ struct Job {
     std::string id;
     std::string name;
     std::string entry_name;
+    // Allocation (the request while pending)
+    std::string state;   // "RUNNING", "PENDING", ...
+    int cpus = 0;
+    int nodes = 0;
+    int64_t mem_mb = 0;
+    int gpus = 0;
+    // Owner and placement, for views over every user's jobs
+    std::string user;
+    std::string account;
+    std::string partition;
+    std::string nodelist;  // Compressed, e.g. "romeo-a[045-046]"; empty while pending
 };
 
 struct NodeAllocation {
     std::string node_name;
-    std::vector<int> allocated_cores;
-    int allocated_gpus;
+    std::string node_prefix;  // Node class, e.g. "romeo-a" for "romeo-a057"
+    IndexSet allocated_cores;  // CPU ids allocated to the job on this node
+    IndexSet allocated_gpus;   // GPU indices allocated to the job on this node
     int total_cores;
     int total_gpus;
 };
@@ -33,6 +51,21 @@ struct PartitionInfo {
     int nodes_down = 0;
     std::string timelimit;
     std::string state;
+    int cpus_total = 0;
+    int cpus_idle = 0;
+    int gpus_total = 0;
+    int gpus_used = 0;
+    int pending_jobs = 0;
+};
+
+// Log files of one job of a set (array task or sweep member)
+struct JobLogs {
+    std::string id;          // "1234_5" for an array task
+    std::string array_task;  // "5", empty outside an array
+    std::string name;
+    std::string state;
+    std::string stdout_path;
+    std::string stderr_path;
 };
 
 struct DetailedJob {
@@ -52,10 +85,18 @@ struct DetailedJob {
     std::vector<NodeAllocation> node_allocations;
 };
 
+// Node class prefix: node name without its trailing digits
+// e.g., "romeo-a057" → "romeo-a", "romeo-gpu01" → "romeo-gpu"
+inline std::string nodeClassPrefix(const std::string& node_name) {
+    size_t end = node_name.size();
+    while (end > 0 && node_name[end - 1] >= '0' && node_name[end - 1] <= '9') end--;
+    return node_name.substr(0, end);
+}
+
 class slurm {
 private:
     static inline std::string exec(const std::string& cmd) {
-        std::array<char, 128> buffer;
+        std::array<char, 1 << 16> buffer;
         std::string result;
 
         std::unique_ptr<FILE, int(*)(FILE*)> pipe(
@@ -63,29 +104,71 @@ private:
             static_cast<int(*)(FILE*)>(pclose)
         );
         if (!pipe) return "";
-        while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-            result += buffer.data();
+        size_t n;
+        while ((n = fread(buffer.data(), 1, buffer.size(), pipe.get())) > 0) {
+            result.append(buffer.data(), n);
         }
         return result;
     }
 
-    static inline std::vector<int> parseCpuIds(const std::string& cpu_ids_str) {
-        std::vector<int> cpu_ids;
-        std::regex re(R"((\d+)-(\d+)|(\d+))");
-        auto begin = std::sregex_iterator(cpu_ids_str.begin(), cpu_ids_str.end(), re);
-        auto end = std::sregex_iterator();
-
-        for (auto it = begin; it != end; ++it) {
-            if ((*it)[1].matched && (*it)[2].matched) {
-                int start = std::stoi((*it)[1].str());
-                int stop  = std::stoi((*it)[2].str());
-                for (int i = start; i <= stop; ++i)
-                    cpu_ids.push_back(i);
-            } else if ((*it)[3].matched) {
-                cpu_ids.push_back(std::stoi((*it)[3].str()));
+    // Value of a whitespace-separated "Key=value" token in a line, or "" if absent
+    static inline std::string tokenValue(const std::string& line, const std::string& key) {
+        size_t pos = 0;
+        while ((pos = line.find(key, pos)) != std::string::npos) {
+            if (pos == 0 || std::isspace((unsigned char)line[pos - 1])) {
+                size_t start = pos + key.size();
+                size_t end = line.find_first_of(" \t\r\n", start);
+                return line.substr(start, end == std::string::npos ? std::string::npos : end - start);
             }
+            pos += key.size();
         }
-        return cpu_ids;
+        return "";
+    }
+
+    // GPU indices from a per-node GRES value, e.g. "gpu:a100:2(IDX:0-1),shard:0".
+    // Without an IDX list (older Slurm), each entry's count is assumed to follow
+    // the indices seen so far, so "gpu:a100:2,gpu:v100:2" is four GPUs.
+    static inline IndexSet parseGpuIds(const std::string& gres) {
+        IndexSet ids;
+        int next = 0;  // First index past those seen
+        size_t entry = 0;
+        while (entry < gres.size()) {
+            // Entries are comma separated, but IDX lists contain commas too
+            size_t end = entry;
+            int depth = 0;
+            while (end < gres.size() && (depth > 0 || gres[end] != ',')) {
+                if (gres[end] == '(') depth++;
+                else if (gres[end] == ')') depth--;
+                end++;
+            }
+            std::string item = gres.substr(entry, end - entry);
+            entry = end + 1;
+
+            if (item.compare(0, 4, "gpu:") != 0 && item != "gpu") continue;
+
+            size_t idx = item.find("(IDX:");
+            if (idx != std::string::npos) {
+                size_t close = item.find(')', idx);
+                auto listed = IndexSet::parse(item.substr(idx + 5, close == std::string::npos ? std::string::npos : close - idx - 5));
+                if (!listed.empty()) {
+                    listed.forEach([&](int i) {
+                        ids.insert(i);
+                        next = std::max(next, i + 1);
+                    });
+                    continue;
+                }
+            }
+
+            std::string spec = item.substr(0, item.find('('));
+            size_t colon = spec.rfind(':');
+            int count = 0;
+            try { count = std::stoi(spec.substr(colon + 1)); } catch (...) {}
+            if (count > 0) {
+                ids.insertRange(next, next + count - 1);
+                next += count;
+            }
+        }
+        return ids;
     }
 
     static inline std::pair<int,int> getNodeInfo(const std::string& node_name) {
@@ -103,53 +186,199 @@ private:
         return {total_cores, total_gpus};
     }
 
-    static inline std::vector<std::string> expandNodelist(const std::string& nodelist) {
-        std::string cmd = "scontrol show hostnames " + nodelist + " 2>/dev/null";
-        std::string out = exec(cmd);
-        std::vector<std::string> nodes;
-        std::istringstream iss(out);
-        std::string line;
-        while (std::getline(iss, line)) {
-            if (!line.empty()) nodes.push_back(line);
-        }
-        return nodes;
+    // Leading integer of a field value ("64", "250000", "4(S:0-1)"), 0 if none
+    static inline long long parseNumber(const std::string& value) {
+        return std::strtoll(value.c_str(), nullptr, 10);
     }
 
-public:
-    static std::vector<Job> getUserJobs() {
-        std::vector<Job> jobs;
+    // Value of one TRES in a list like "cpu=128,mem=250G,gres/gpu=4"; empty if absent
+    static inline std::string tresValue(const std::string& tres, const std::string& key) {
+        size_t pos = 0;
+        while ((pos = tres.find(key, pos)) != std::string::npos) {
+            if (pos == 0 || tres[pos - 1] == ',') {
+                size_t start = pos + key.size();
+                return tres.substr(start, tres.find(',', start) - start);
+            }
+            pos += key.size();
+        }
+        return "";
+    }
 
-        const char* user = std::getenv("USER");
-        if (!user) user = "unknown";
+    static inline int tresCount(const std::string& tres, const std::string& key) {
+        return (int)parseNumber(tresValue(tres, key));
+    }
 
-        std::string cmd = "squeue -u " + std::string(user) + " -o \"%i %j\" --noheader";
+    static inline NodeState parseNodeState(const std::string& state) {
+        auto has = [&](const char* s) { return state.find(s) != std::string::npos; };
+        if (has("DOWN") || has("FAIL") || has("NOT_RESPONDING") || has("*")) return NodeState::Down;
+        if (has("DRAIN")) return NodeState::Drain;
+        if (state.compare(0, 5, "ALLOC") == 0) return NodeState::Allocated;
+        if (state.compare(0, 3, "MIX") == 0) return NodeState::Mixed;
+        if (state.compare(0, 4, "IDLE") == 0) return NodeState::Idle;
+        return NodeState::Other;
+    }
 
-        std::array<char, 256> buffer;
-        std::unique_ptr<FILE, int(*)(FILE*)> pipe(
-            popen(cmd.c_str(), "r"),
-            static_cast<int(*)(FILE*)>(pclose)
-        );
+    // Expand a Slurm hostlist locally (no scontrol fork), preserving zero padding:
+    // "romeo-a[045-046,050],romeo-gpu01" → romeo-a045 romeo-a046 romeo-a050 romeo-gpu01
+    static inline void expandHostlistInto(const std::string& expr, std::vector<std::string>& out) {
+        size_t open = expr.find('[');
+        if (open == std::string::npos) {
+            if (!expr.empty()) out.push_back(expr);
+            return;
+        }
+        size_t close = expr.find(']', open);
+        if (close == std::string::npos) {
+            out.push_back(expr);
+            return;
+        }
 
-        if (!pipe) {
-            std::cerr << "Failed to run squeue command\n";
-            return jobs;
+        std::string prefix = expr.substr(0, open);
+        std::string ranges = expr.substr(open + 1, close - open - 1);
+        std::string suffix = expr.substr(close + 1);
+
+        std::stringstream ss(ranges);
+        std::string range;
+        while (std::getline(ss, range, ',')) {
+            size_t dash = range.find('-');
+            std::string lo = range.substr(0, dash);
+            std::string hi = dash == std::string::npos ? lo : range.substr(dash + 1);
+            int first = 0, last = 0;
+            try { first = std::stoi(lo); last = std::stoi(hi); } catch (...) { continue; }
+
+            for (int i = first; i <= last; ++i) {
+                std::string num = std::to_string(i);
+                if (num.size() < lo.size()) num.insert(0, lo.size() - num.size(), '0');
+                // Further brackets (e.g. "a[1-2]b[3-4]") are expanded recursively
+                expandHostlistInto(prefix + num + suffix, out);
+            }
         }
+    }
 
-        while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-            std::string line = buffer.data();
-            if (line.empty()) continue;
+    // sacct rows of the jobs selected by `filter`, with their log paths expanded
+    // `user` owns the jobs, for %u in their patterns
+    static std::vector<JobLogs> sacctJobLogs(const std::string& filter, const std::string& user) {
+        std::string cmd = "sacct -X -n -P " + filter + " -o JobID,JobIDRaw,JobName,State,WorkDir";
+        // Older sacct rejects the StdOut field and prints nothing
+        std::string out = exec(cmd + ",StdOut,StdErr 2>/dev/null");
+        bool has_patterns = !out.empty();
+        if (!has_patterns) out = exec(cmd + " 2>/dev/null");
+
+        // Arrays of many thousand tasks: parsed on every core
+        return parse::parallel<JobLogs>(out, [&](std::string_view chunk, std::vector<JobLogs>& jobs) {
+            parseJobLogs(chunk, has_patterns, user, jobs);
+        }, parse::anyLine);
+    }
 
-            std::istringstream iss(line);
-            Job job;
-            iss >> job.id >> job.name;
-            job.entry_name = (job.name + " (" + job.id + ")");
+    static void parseJobLogs(std::string_view out, bool has_patterns, const std::string& user, std::vector<JobLogs>& jobs) {
+        std::vector<std::string_view> fields;
+        std::vector<std::string> f;
+        parse::forEachLine(out, [&](std::string_view line) {
+            parse::splitFields(line, '|', fields);
+            f.assign(fields.begin(), fields.end());
+            // f: id ("1234_5"), numeric job id, name, state, workdir[, stdout, stderr]
+            if (f.size() < 5 || f[0].empty()) return;
+            // Pending ranges ("1234_[6-9]") have no log yet
+            if (f[0].find('[') != std::string::npos) return;
+
+            JobLogs job;
+            job.id = f[0];
+            size_t underscore = f[0].find('_');
+            std::string array_id = underscore == std::string::npos ? "" : f[0].substr(0, underscore);
+            if (!array_id.empty()) job.array_task = f[0].substr(underscore + 1);
+            job.name = f[2];
+            job.state = f[3].substr(0, f[3].find(' '));  // "CANCELLED by 1234"
+
+            std::string out_pattern = has_patterns && f.size() > 5 ? f[5] : "";
+            std::string err_pattern = has_patterns && f.size() > 6 ? f[6] : "";
+            if (out_pattern.empty()) out_pattern = array_id.empty() ? "slurm-%j.out" : "slurm-%A_%a.out";
+            if (err_pattern.empty()) err_pattern = out_pattern;
+            auto expand = [&](const std::string& pattern) {
+                std::string path =
+                    expandSlurmPath(pattern, f[1], job.name, array_id.empty() ? f[1] : array_id, job.array_task, user);
+                return path.empty() || path[0] == '/' || f[4].empty() ? path : f[4] + "/" + path;
+            };
+            job.stdout_path = expand(out_pattern);
+            job.stderr_path = expand(err_pattern);
+            jobs.push_back(std::move(job));
+        });
+    }
 
-            if (!job.id.empty() && !job.name.empty()) {
-                jobs.push_back(job);
+public:
+    static std::vector<std::string> expandNodelist(const std::string& nodelist) {
+        std::vector<std::string> nodes;
+        size_t start = 0;
+        int depth = 0;
+        for (size_t i = 0; i <= nodelist.size(); ++i) {
+            if (i < nodelist.size() && nodelist[i] == '[') depth++;
+            else if (i < nodelist.size() && nodelist[i] == ']') depth--;
+            else if (i == nodelist.size() || (nodelist[i] == ',' && depth == 0)) {
+                expandHostlistInto(nodelist.substr(start, i - start), nodes);
+                start = i + 1;
             }
         }
+        return nodes;
+    }
 
-        return jobs;
+    // "250G", "4000M", "512000" (MB when there is no unit) in MB
+    static inline int64_t parseMemoryMB(const std::string& value) {
+        char* end;
+        double mb = std::strtod(value.c_str(), &end);
+        switch (*end) {
+            case 'K': case 'k': mb /= 1024; break;
+            case 'G': case 'g': mb *= 1024; break;
+            case 'T': case 't': mb *= 1024 * 1024; break;
+        }
+        return (int64_t)mb;
+    }
+
+    static std::vector<Job> getUserJobs() {
+        const char* user = std::getenv("USER");
+        if (!user) user = "unknown";
+
+        std::string cmd = "squeue -u " + std::string(user) + " -O \"" + JOBS_FORMAT + "\" --noheader";
+        return parseJobs(exec(cmd));
+    }
+
+    // Every job of the cluster (hidden partitions included), for --all
+    static std::vector<Job> getAllJobs() {
+        return parseJobs(exec(std::string("squeue -a -O \"") + JOBS_FORMAT + "\" --noheader"));
+    }
+
+    // Job id, state, CPUs, nodes, TRES of the whole job (requested while
+    // pending), user, account, partition, node list, then the name (which may
+    // hold a '|'). A ':' with no width prints a field unpadded, '|' follows it.
+    static constexpr const char* JOBS_FORMAT =
+        "JobArrayID:|,State:|,NumCPUs:|,NumNodes:|,tres-alloc:|,UserName:|,Account:|,Partition:|,NodeList:|,Name:";
+
+    // JOBS_FORMAT lines of squeue; large outputs are parsed on every core
+    static std::vector<Job> parseJobs(std::string_view out, size_t threads = 0) {
+        return parse::parallel<Job>(out, [](std::string_view chunk, std::vector<Job>& jobs) {
+            std::vector<std::string_view> f;
+            parse::forEachLine(chunk, [&](std::string_view line) {
+                parse::splitFields(line, '|', f);
+                if (f.size() < 10 || f[0].empty()) return;
+                std::string_view name = line.substr((size_t)(f[9].data() - line.data()));
+                if (name.empty()) return;
+
+                Job job;
+                job.id = f[0];
+                job.name = name;
+                job.entry_name = job.name + " (" + job.id + ")";
+                job.state = f[1];
+                job.cpus = (int)parseNumber(std::string(f[2]));
+                job.nodes = (int)parseNumber(std::string(f[3]));
+                // Totals, whether memory was asked per node or per CPU and
+                // GPUs per node, per task or per job
+                std::string tres(f[4]);
+                job.mem_mb = parseMemoryMB(tresValue(tres, "mem="));
+                job.gpus = tresCount(tres, "gres/gpu=");
+                job.user = f[5];
+                job.account = f[6];
+                job.partition = f[7];
+                if (f[8] != "(null)") job.nodelist = f[8];
+                jobs.push_back(std::move(job));
+            });
+        }, parse::anyLine, threads);
     }
 
     static DetailedJob getJobDetails(const std::string& job_id) {
@@ -174,64 +403,108 @@ public:
             else if (key == "Reason") job.reason = val;
         }
 
-        std::regex nodes_re(R"(^\s*Nodes=([^\s]+))", std::regex_constants::multiline);
-        std::smatch m;
+        // Per-node allocation lines of -dd, one per group of identical nodes:
+        //   Nodes=romeo-a[045-046] CPU_IDs=0-7 Mem=512 GRES=gpu:a100:2(IDX:0-1)
+        std::istringstream lines(sctrl);
+        std::string line;
+        while (std::getline(lines, line)) {
+            std::string node_expr = tokenValue(line, "Nodes=");
+            std::string cpu_str = tokenValue(line, "CPU_IDs=");
+            if (node_expr.empty() || cpu_str.empty()) continue;
 
-        if (std::regex_search(sctrl, m, nodes_re)) {
-            auto node_str = m[1].str();
-            auto nodes = expandNodelist(node_str);
-
-            std::regex cpu_re(R"(CPU_IDs=([^\s]+))");
-            std::smatch cpu_m;
-            if (!std::regex_search(sctrl, cpu_m, cpu_re)) return job;
-            auto cpu_str = cpu_m[1].str();
-
-            std::vector<std::string> cpu_groups;
-            std::stringstream ss(cpu_str);
-            std::string group;
-            while (std::getline(ss, group, ',')) cpu_groups.push_back(group);
-
-            auto cpu_ids = parseCpuIds(cpu_str);
-            int nodes_count = nodes.size();
-            int cpus_per_node = cpu_ids.size() / nodes_count;
-            int group_index = 0;
-
-            std::regex gpu_re(R"(GRES=([^\s]+))");
-            std::smatch gpu_m;
-            int allocated_gpus = 0;
-            
-            if (std::regex_search(sctrl, gpu_m, gpu_re)) {
-                std::string gres = gpu_m[1].str();
-                std::regex gpunum(R"(gpu:[^:]*:(\d+))");
-                std::smatch gm;
-                if (std::regex_search(gres, gm, gpunum))
-                    allocated_gpus = std::stoi(gm[1].str());
-            }
+            IndexSet cores = IndexSet::parse(cpu_str);
+            IndexSet gpus = parseGpuIds(tokenValue(line, "GRES="));
 
-            for (auto& n : nodes) {
+            for (auto& n : expandNodelist(node_expr)) {
                 NodeAllocation na;
                 na.node_name = n;
-                
+                na.node_prefix = nodeClassPrefix(n);
+
                 auto [total_cores, total_gpus] = getNodeInfo(n);
-                
+
                 na.total_cores = total_cores;
                 na.total_gpus = total_gpus;
-                na.allocated_gpus = allocated_gpus / nodes.size();
-
-                na.allocated_cores.clear();
-                for (int i = 0; i < cpus_per_node; ++i) {
-                    auto& g = cpu_ids[(group_index * cpus_per_node) + i];
-                    na.allocated_cores.push_back(g);
-                }
+                na.allocated_cores = cores;
+                na.allocated_gpus = gpus;
 
-                group_index++;
-                job.node_allocations.push_back(na);
+                job.node_allocations.push_back(std::move(na));
             }
         }
 
         return job;
     }
 
+    // Build the node table from `scontrol show node -o` (one line per node)
+    static NodeTable parseNodeTable(const std::string& out) {
+        struct Row {
+            std::string name, prefix;
+            int32_t cpu_alloc, cpu_total, gpu_used, gpu_total;
+            int64_t mem_alloc, mem_total;
+            NodeState state;
+        };
+        std::vector<Row> rows;
+
+        std::istringstream iss(out);
+        std::string line;
+        while (std::getline(iss, line)) {
+            std::string name = tokenValue(line, "NodeName=");
+            if (name.empty()) continue;
+
+            Row r;
+            r.name = name;
+            r.prefix = nodeClassPrefix(name);
+            r.cpu_alloc = (int32_t)parseNumber(tokenValue(line, "CPUAlloc="));
+            r.cpu_total = (int32_t)parseNumber(tokenValue(line, "CPUTot="));
+            r.mem_alloc = parseNumber(tokenValue(line, "AllocMem="));
+            r.mem_total = parseNumber(tokenValue(line, "RealMemory="));
+            r.gpu_total = tresCount(tokenValue(line, "CfgTRES="), "gres/gpu=");
+            if (r.gpu_total == 0) r.gpu_total = parseGpuIds(tokenValue(line, "Gres=")).count();
+            r.gpu_used = tresCount(tokenValue(line, "AllocTRES="), "gres/gpu=");
+            r.state = parseNodeState(tokenValue(line, "State="));
+            rows.push_back(std::move(r));
+        }
+
+        // Group classes contiguously, keeping scontrol's node order inside a class
+        std::stable_sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+            return a.prefix < b.prefix;
+        });
+
+        NodeTable t;
+        size_t n = rows.size();
+        t.names.reserve(n);
+        t.class_id.reserve(n);
+        t.cpu_alloc.reserve(n);
+        t.cpu_total.reserve(n);
+        t.gpu_used.reserve(n);
+        t.gpu_total.reserve(n);
+        t.mem_alloc.reserve(n);
+        t.mem_total.reserve(n);
+        t.state.reserve(n);
+
+        for (size_t i = 0; i < n; ++i) {
+            auto& r = rows[i];
+            if (t.class_prefixes.empty() || t.class_prefixes.back() != r.prefix) {
+                t.class_prefixes.push_back(r.prefix);
+                t.class_begin.push_back((uint32_t)i);
+            }
+            t.names.push_back(std::move(r.name));
+            t.class_id.push_back((uint16_t)(t.class_prefixes.size() - 1));
+            t.cpu_alloc.push_back(r.cpu_alloc);
+            t.cpu_total.push_back(r.cpu_total);
+            t.gpu_used.push_back(r.gpu_used);
+            t.gpu_total.push_back(r.gpu_total);
+            t.mem_alloc.push_back(r.mem_alloc);
+            t.mem_total.push_back(r.mem_total);
+            t.state.push_back(r.state);
+        }
+        t.class_begin.push_back((uint32_t)n);
+        return t;
+    }
+
+    static NodeTable getNodeTable() {
+        return parseNodeTable(exec("scontrol show node -o 2>/dev/null"));
+    }
+
     static bool cancelJob(const std::string& job_id) {
         std::string cmd = "scancel " + job_id + " 2>&1";
         std::string result = exec(cmd);
@@ -241,20 +514,54 @@ public:
     static std::vector<PartitionInfo> getPartitions() {
         std::vector<PartitionInfo> partitions;
 
-        // Get partition summary with node states
-        std::string cmd = "sinfo -o \"%P %a %l %D %T\" --noheader 2>/dev/null";
+        // One shell round-trip: sinfo rows (one per partition and node state),
+        // then one squeue line per pending job. Fields are '|' separated and
+        // sized so sinfo does not truncate them.
+        std::string cmd =
+            "sinfo -h -O \"Partition:40|,Available:10|,Time:20|,Nodes:10|,StateLong:30|,"
+            "CPUsState:40|,Gres:200|,GresUsed:200|\" 2>/dev/null; "
+            "echo '#pending'; squeue -h -t PD -o \"%P\" 2>/dev/null";
         std::string out = exec(cmd);
 
         std::map<std::string, PartitionInfo> part_map;
 
+        auto trim = [](std::string s) {
+            size_t b = s.find_first_not_of(' ');
+            size_t e = s.find_last_not_of(' ');
+            return b == std::string::npos ? std::string() : s.substr(b, e - b + 1);
+        };
+
         std::istringstream iss(out);
         std::string line;
+        bool pending_section = false;
         while (std::getline(iss, line)) {
             if (line.empty()) continue;
+            if (line == "#pending") {
+                pending_section = true;
+                continue;
+            }
 
+            if (pending_section) {
+                // A job submitted to "a,b" waits in both partitions
+                std::istringstream pss(line);
+                std::string part;
+                while (std::getline(pss, part, ',')) {
+                    auto it = part_map.find(trim(part));
+                    if (it != part_map.end()) it->second.pending_jobs++;
+                }
+                continue;
+            }
+
+            std::vector<std::string> fields;
             std::istringstream lss(line);
-            std::string name, avail, timelimit, nodes_str, state;
-            lss >> name >> avail >> timelimit >> nodes_str >> state;
+            std::string field;
+            while (std::getline(lss, field, '|')) fields.push_back(trim(field));
+            if (fields.size() < 5) continue;
+
+            std::string name = fields[0];
+            const std::string& avail = fields[1];
+            const std::string& timelimit = fields[2];
+            const std::string& state = fields[4];
 
             // Remove trailing '*' from default partition
             if (!name.empty() && name.back() == '*') {
@@ -262,10 +569,14 @@ public:
             }
 
             int nodes = 0;
-            try { nodes = std::stoi(nodes_str); } catch (...) {}
+            try { nodes = std::stoi(fields[3]); } catch (...) {}
 
             if (part_map.find(name) == part_map.end()) {
-                part_map[name] = PartitionInfo{name, 0, 0, 0, 0, 0, timelimit, avail};
+                PartitionInfo info;
+                info.name = name;
+                info.timelimit = timelimit;
+                info.state = avail;
+                part_map[name] = info;
             }
 
             auto& p = part_map[name];
@@ -276,6 +587,27 @@ public:
             else if (state.find("alloc") != std::string::npos) p.nodes_alloc += nodes;
             else if (state.find("down") != std::string::npos ||
                      state.find("drain") != std::string::npos) p.nodes_down += nodes;
+
+            // CPUsState is "allocated/idle/other/total" summed over the row's nodes
+            if (fields.size() > 5) {
+                int cpu[4] = {0, 0, 0, 0};
+                std::istringstream css(fields[5]);
+                std::string n;
+                for (int i = 0; i < 4 && std::getline(css, n, '/'); ++i) {
+                    try { cpu[i] = std::stoi(n); } catch (...) {}
+                }
+                p.cpus_idle += cpu[1];
+                p.cpus_total += cpu[3];
+            }
+
+            // Gres and GresUsed are per node; every node of a row shares them.
+            // Unavailable nodes contribute no usable GPUs.
+            bool usable = state.find("down") == std::string::npos &&
+                          state.find("drain") == std::string::npos;
+            if (fields.size() > 7 && usable) {
+                p.gpus_total += nodes * parseGpuIds(fields[6]).count();
+                p.gpus_used += nodes * parseGpuIds(fields[7]).count();
+            }
         }
 
         for (auto& [name, p] : part_map) {
@@ -289,49 +621,180 @@ public:
         return exec("scontrol show job " + job_id + " 2>&1");
     }
 
-    static std::string expandSlurmPath(const std::string& path, const std::string& job_id, const std::string& job_name) {
-        std::string result = path;
+    // Owner of the jobs to look up: `user`, or the current user when empty
+    static std::string jobOwner(const std::string& user) {
+        if (!user.empty()) return user;
+        const char* current = std::getenv("USER");
+        return current ? current : "unknown";
+    }
 
+    // Expand the filename patterns of --output/--error: %j, %J, %x, %A, %a,
+    // %u (the job's owner, the current user by default) and %%. A width
+    // ("%4a") zero-pads numbers. Patterns without a value here (%A outside an
+    // array, %N, ...) are kept as they are.
+    static std::string expandSlurmPath(const std::string& path, const std::string& job_id, const std::string& job_name,
+                                       const std::string& array_job_id = "", const std::string& array_task_id = "",
+                                       const std::string& owner = "") {
         // Extract base job ID (without step)
-        std::string base_job_id = job_id;
-        size_t dot_pos = job_id.find('.');
-        if (dot_pos != std::string::npos) {
-            base_job_id = job_id.substr(0, dot_pos);
-        }
+        std::string base_job_id = job_id.substr(0, job_id.find('.'));
+        std::string user = jobOwner(owner);
 
-        // Replace SLURM placeholders
-        // %J = jobid.stepid, %j = jobid
-        size_t pos;
-        while ((pos = result.find("%J")) != std::string::npos) {
-            result.replace(pos, 2, job_id);
-        }
-        while ((pos = result.find("%j")) != std::string::npos) {
-            result.replace(pos, 2, base_job_id);
-        }
-        while ((pos = result.find("%x")) != std::string::npos) {
-            result.replace(pos, 2, job_name);
+        std::string result;
+        size_t i = 0;
+        while (i < path.size()) {
+            if (path[i] != '%') {
+                result += path[i++];
+                continue;
+            }
+            size_t spec = i + 1;
+            while (spec < path.size() && std::isdigit((unsigned char)path[spec])) spec++;
+            if (spec >= path.size()) break;
+
+            std::string value;
+            bool numeric = true;
+            switch (path[spec]) {
+                case '%': value = "%"; numeric = false; break;
+                case 'J': value = job_id; numeric = false; break;  // jobid.stepid
+                case 'j': value = base_job_id; break;
+                case 'A': value = array_job_id; break;
+                case 'a': value = array_task_id; break;
+                case 'x': value = job_name; numeric = false; break;
+                case 'u': value = user; numeric = false; break;
+            }
+            if (value.empty()) {
+                result.append(path, i, spec + 1 - i);
+            } else {
+                int width = spec > i + 1 ? std::atoi(path.substr(i + 1, spec - i - 1).c_str()) : 0;
+                if (numeric && (int)value.size() < width) result.append(width - value.size(), '0');
+                result += value;
+            }
+            i = spec + 1;
         }
-
+        result.append(path, i, std::string::npos);
         return result;
     }
 
     static std::pair<std::string, std::string> getJobLogPaths(const std::string& job_id) {
         std::string raw = exec("scontrol show job " + job_id + " 2>/dev/null");
 
-        std::string stdout_path, stderr_path, job_name;
+        std::string stdout_path, stderr_path, job_name, user;
 
         std::regex stdout_re(R"(StdOut=([^\s]+))");
         std::regex stderr_re(R"(StdErr=([^\s]+))");
         std::regex name_re(R"(JobName=([^\s]+))");
+        std::regex user_re(R"(UserId=([^\s(]+))");
 
         std::smatch m;
         if (std::regex_search(raw, m, name_re)) job_name = m[1].str();
-        if (std::regex_search(raw, m, stdout_re)) stdout_path = expandSlurmPath(m[1].str(), job_id, job_name);
-        if (std::regex_search(raw, m, stderr_re)) stderr_path = expandSlurmPath(m[1].str(), job_id, job_name);
+        if (std::regex_search(raw, m, user_re)) user = m[1].str();
+        if (std::regex_search(raw, m, stdout_re)) stdout_path = expandSlurmPath(m[1].str(), job_id, job_name, "", "", user);
+        if (std::regex_search(raw, m, stderr_re)) stderr_path = expandSlurmPath(m[1].str(), job_id, job_name, "", "", user);
 
         return {stdout_path, stderr_path};
     }
 
+    // Jobs whose logs belong with job_id's: every queued task of its array,
+    // or else every job of its owner (`user`, the current user when empty)
+    // with the same name (a sweep submitted in a loop). One squeue call;
+    // pending array ranges have no log yet.
+    static std::vector<JobLogs> getRelatedJobLogs(const std::string& job_id, const std::string& user = "") {
+        std::string owner = jobOwner(user);
+        std::string out = exec("squeue -h -u " + owner +
+                               " -O \"JobArrayID:40|,JobID:20|,ArrayJobID:20|,ArrayTaskID:20|,Name:200|,State:20|,"
+                               "STDOUT:500|,STDERR:500|\" 2>/dev/null");
+
+        auto trim = [](std::string s) {
+            size_t b = s.find_first_not_of(' ');
+            size_t e = s.find_last_not_of(' ');
+            return b == std::string::npos ? std::string() : s.substr(b, e - b + 1);
+        };
+
+        struct Row {
+            JobLogs logs;
+            std::string array_id;
+        };
+        std::vector<Row> rows;
+        std::istringstream iss(out);
+        std::string line;
+        while (std::getline(iss, line)) {
+            std::vector<std::string> f;
+            std::istringstream lss(line);
+            std::string field;
+            while (std::getline(lss, field, '|')) f.push_back(trim(field));
+            if (f.size() < 8 || f[0].empty()) continue;
+
+            // f: id as listed ("1234_5"), numeric job id, array job id, task id, name, state, stdout, stderr
+            Row r;
+            bool in_array = f[3] != "N/A";
+            r.logs.id = f[0];
+            r.array_id = in_array ? f[2] : "";
+            r.logs.array_task = in_array ? f[3] : "";
+            r.logs.name = f[4];
+            r.logs.state = f[5];
+            std::string base = in_array ? f[2] : f[1];
+            r.logs.stdout_path = expandSlurmPath(f[6], f[1], f[4], base, r.logs.array_task, owner);
+            r.logs.stderr_path = expandSlurmPath(f[7], f[1], f[4], base, r.logs.array_task, owner);
+            rows.push_back(std::move(r));
+        }
+
+        // The selected job: exact id, or the array it belongs to ("1234", "1234_[5-9]")
+        std::string base_id = job_id.substr(0, job_id.find('_'));
+        const Row* self = nullptr;
+        for (const auto& r : rows) {
+            if (r.logs.id == job_id) self = &r;
+        }
+        if (!self) {
+            for (const auto& r : rows) {
+                if (r.array_id == base_id) self = &r;
+            }
+        }
+        if (!self) return {};
+
+        std::vector<JobLogs> related;
+        for (const auto& r : rows) {
+            bool same = self->array_id.empty() ? r.array_id.empty() && r.logs.name == self->logs.name
+                                               : r.array_id == self->array_id;
+            // Pending ranges ("5-9", "5,7") are not a single task
+            bool range = r.logs.array_task.find_first_of("-,[") != std::string::npos;
+            if (same && !range) related.push_back(r.logs);
+        }
+        return related;
+    }
+
+    // Every job of job_id's set, finished ones included: all tasks of its
+    // array, or else its owner's jobs of the same name over the last week.
+    // Filename patterns come from sacct (StdOut/StdErr, Slurm 23.02+) or are
+    // Slurm's defaults, relative to the job's WorkDir; queued jobs use the
+    // paths squeue reports. Without accounting, the queued jobs only.
+    static std::vector<JobLogs> getJobSetLogs(const std::string& job_id, const std::string& user = "") {
+        std::string owner = jobOwner(user);
+        std::string base_id = job_id.substr(0, job_id.find('_'));
+        auto jobs = sacctJobLogs("-j " + base_id, owner);
+        if (jobs.empty()) return getRelatedJobLogs(job_id, owner);
+
+        bool array = std::any_of(jobs.begin(), jobs.end(), [](const JobLogs& j) { return !j.array_task.empty(); });
+        if (!array) {
+            std::string name = jobs[0].name;
+            // Quoted for the shell
+            std::string quoted = "'";
+            for (char c : name) quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+            quoted += "'";
+            auto named = sacctJobLogs("-u " + owner + " --name=" + quoted + " -S now-7days", owner);
+            if (!named.empty()) jobs = std::move(named);
+        }
+
+        std::map<std::string, const JobLogs*> queued;
+        auto related = getRelatedJobLogs(job_id, owner);
+        for (const auto& r : related) queued[r.id] = &r;
+        for (auto& j : jobs) {
+            auto it = queued.find(j.id);
+            if (it == queued.end()) continue;
+            j.stdout_path = it->second->stdout_path;
+            j.stderr_path = it->second->stderr_path;
+        }
+        return jobs;
+    }
+
 };
 
 }
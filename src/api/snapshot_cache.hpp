@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace api {
+
+// Latest result of a slow Slurm query, refreshed on a background thread.
+// Readers get an immutable snapshot and never wait for the command to run.
+template <typename T>
+class SnapshotCache {
+public:
+    using Clock = std::chrono::system_clock;
+
+    SnapshotCache(std::function<T()> fetch, std::chrono::seconds ttl)
+        : fetch_(std::move(fetch)), ttl_(ttl) {}
+
+    ~SnapshotCache() { stop(); }
+
+    // Waits for a running fetch without calling its on_done, and starts no
+    // other: for caches that outlive what their callbacks capture
+    void stop() {
+        stopped_ = true;
+        if (worker_.joinable()) worker_.join();
+    }
+
+    SnapshotCache(const SnapshotCache&) = delete;
+    SnapshotCache& operator=(const SnapshotCache&) = delete;
+
+    // Current snapshot, null until the first fetch completes
+    std::shared_ptr<const T> get() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return value_;
+    }
+
+    Clock::time_point updatedAt() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return updated_at_;
+    }
+
+    // Incremented on every completed fetch
+    uint64_t version() const { return version_; }
+
+    bool refreshing() const { return busy_; }
+
+    bool stale() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return !value_ || Clock::now() - updated_at_ >= ttl_;
+    }
+
+    // Fetch in the background unless a fetch is already running.
+    // on_done runs on the worker thread once the new snapshot is visible.
+    void refreshAsync(std::function<void()> on_done = {}) {
+        if (stopped_) return;
+        bool expected = false;
+        if (!busy_.compare_exchange_strong(expected, true)) return;
+        if (worker_.joinable()) worker_.join();
+
+        worker_ = std::thread([this, on_done = std::move(on_done)] {
+            auto value = std::make_shared<const T>(fetch_());
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                value_ = std::move(value);
+                updated_at_ = Clock::now();
+            }
+            version_++;
+            busy_ = false;
+            if (on_done && !stopped_) on_done();
+        });
+    }
+
+    void refreshIfStale(std::function<void()> on_done = {}) {
+        if (stale()) refreshAsync(std::move(on_done));
+    }
+
+private:
+    std::function<T()> fetch_;
+    std::chrono::seconds ttl_;
+
+    mutable std::mutex mutex_;
+    std::shared_ptr<const T> value_;
+    Clock::time_point updated_at_;
+    std::atomic<uint64_t> version_{0};
+    std::atomic<bool> busy_{false};
+    std::atomic<bool> stopped_{false};
+    std::thread worker_;
+};
+
+}
@@ -0,0 +1,187 @@
+#pragma once
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "log_file.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define RSV_SEARCH_AVX2 1
+#endif
+
+namespace api {
+
+namespace detail {
+
+// memchr on the first byte, then verify the rest
+template <typename F>
+inline void findAllScalar(const char* data, size_t n, std::string_view needle, size_t from, F&& on_match) {
+    const size_t k = needle.size();
+    const char* p = data + from;
+    const char* last = data + n - k;
+    while (p <= last) {
+        p = static_cast<const char*>(std::memchr(p, needle[0], (size_t)(last - p) + 1));
+        if (!p) return;
+        if (std::memcmp(p + 1, needle.data() + 1, k - 1) == 0) on_match((size_t)(p - data));
+        p++;
+    }
+}
+
+#ifdef RSV_SEARCH_AVX2
+// 32 candidate positions per step: compare the first and the last byte of the
+// needle at once, memcmp only where both match. Returns where it stopped.
+__attribute__((target("avx2")))
+inline size_t findAllAvx2(const char* data, size_t n, std::string_view needle,
+                          const std::function<void(size_t)>& on_match) {
+    const size_t k = needle.size();
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[k - 1]);
+    size_t i = 0;
+    for (; i + k - 1 + 32 <= n; i += 32) {
+        __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + k - 1));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last)));
+        while (mask) {
+            size_t bit = (size_t)__builtin_ctz(mask);
+            if (k <= 2 || std::memcmp(data + i + bit + 1, needle.data() + 1, k - 2) == 0) on_match(i + bit);
+            mask &= mask - 1;
+        }
+    }
+    return i;
+}
+#endif
+
+}
+
+// Call on_match(position) for every occurrence of needle in data[0, n), in order.
+// Uses AVX2 when the CPU has it, memchr + memcmp otherwise.
+inline void findAll(const char* data, size_t n, std::string_view needle, const std::function<void(size_t)>& on_match) {
+    if (needle.empty() || n < needle.size()) return;
+    size_t from = 0;
+#ifdef RSV_SEARCH_AVX2
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2 && needle.size() > 1) from = detail::findAllAvx2(data, n, needle, on_match);
+#endif
+    detail::findAllScalar(data, n, needle, from, on_match);
+}
+
+// Whole-file search on a background thread. The file is read one block at a
+// time (decompressed as a stream when compressed) and scanned with findAll();
+// match offsets are published as each block completes, so the first results
+// show up long before the scan ends.
+class TextSearch {
+public:
+    static constexpr size_t STREAM_BLOCK = 4 << 20;
+    static constexpr auto PROGRESS_INTERVAL = std::chrono::milliseconds(250);
+
+    TextSearch(std::string path, std::string needle, std::function<void()> on_progress = {})
+        : path_(std::move(path)), needle_(std::move(needle)), on_progress_(std::move(on_progress)) {
+        running_ = true;
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~TextSearch() {
+        stop_ = true;
+        if (thread_.joinable()) thread_.join();
+    }
+
+    TextSearch(const TextSearch&) = delete;
+    TextSearch& operator=(const TextSearch&) = delete;
+
+    const std::string& needle() const { return needle_; }
+    bool done() const { return !running_; }
+    // Progress, in bytes of the file on disk
+    uint64_t scannedBytes() const { return scanned_; }
+    uint64_t fileSize() const { return file_size_; }
+
+    size_t matchCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return matches_.size();
+    }
+
+    uint64_t match(size_t i) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return matches_[i];
+    }
+
+    // Index of the first match at or after a byte offset (matchCount() if none yet)
+    size_t firstAtOrAfter(uint64_t offset) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (size_t)(std::lower_bound(matches_.begin(), matches_.end(), offset) - matches_.begin());
+    }
+
+private:
+    // Read with pread, never mapped: the log of a running job may be
+    // truncated under the scan (requeued with --open-mode=truncate,
+    // copytruncate rotation), and a mapped page past the new end is a SIGBUS
+    void run() {
+        if (auto file = LogFile::open(path_)) {
+            struct stat st;
+            if (::stat(path_.c_str(), &st) == 0) file_size_ = (uint64_t)st.st_size;
+            scanStream(*file);
+        }
+        running_ = false;
+        if (on_progress_) on_progress_();
+    }
+
+    // Blocks of content overlapping by needle - 1 bytes, so that matches across
+    // a boundary are found once
+    void scanStream(LogFile& file) {
+        const size_t keep = needle_.size() - 1;
+        std::vector<char> buffer(STREAM_BLOCK + keep);
+        std::vector<uint64_t> found;
+        auto last_progress = std::chrono::steady_clock::now();
+        uint64_t base = 0;  // Content offset of buffer[0]
+        size_t filled = 0;
+
+        while (!stop_) {
+            size_t n = file.read(buffer.data() + filled, STREAM_BLOCK, base + filled);
+            if (n == 0) break;
+            filled += n;
+
+            found.clear();
+            findAll(buffer.data(), filled, needle_, [&](size_t pos) { found.push_back(base + pos); });
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                matches_.insert(matches_.end(), found.begin(), found.end());
+            }
+            scanned_ = file.consumed();
+
+            size_t tail = std::min(keep, filled);
+            std::memmove(buffer.data(), buffer.data() + filled - tail, tail);
+            base += filled - tail;
+            filled = tail;
+
+            auto now = std::chrono::steady_clock::now();
+            if (on_progress_ && now - last_progress >= PROGRESS_INTERVAL) {
+                last_progress = now;
+                on_progress_();
+            }
+        }
+    }
+
+    std::string path_;
+    std::string needle_;
+    std::function<void()> on_progress_;
+
+    mutable std::mutex mutex_;
+    std::vector<uint64_t> matches_;
+    std::atomic<uint64_t> scanned_{0};
+    std::atomic<uint64_t> file_size_{0};
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+}
@@ -2,7 +2,9 @@
 
 #include <ftxui/component/component.hpp>
 #include <ftxui/dom/elements.hpp>
+#include <ctime>
 #include "../api/slurmjobs.hpp"
+#include "../api/snapshot_cache.hpp"
 
 namespace ui {
 using namespace ftxui;
@@ -28,9 +30,33 @@ inline Element renderPartitionBar(const api::PartitionInfo& p) {
     return hbox(bar_parts);
 }
 
-inline Component clusterView() {
-    return Renderer([] {
-        auto partitions = api::slurm::getPartitions();
+using PartitionSnapshot = api::SnapshotCache<std::vector<api::PartitionInfo>>;
+
+// "updated 14:02:31 (12s ago)", plus a marker while a refresh is running
+inline Element snapshotStamp(const PartitionSnapshot& cache) {
+    std::string stamp = "Loading...";
+    if (cache.get()) {
+        auto updated = cache.updatedAt();
+        std::time_t t = std::chrono::system_clock::to_time_t(updated);
+        std::tm tm{};
+        localtime_r(&t, &tm);
+        char clock[16];
+        std::strftime(clock, sizeof(clock), "%H:%M:%S", &tm);
+        auto age = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now() - updated).count();
+        stamp = "Updated " + std::string(clock) + " (" + std::to_string(age) + "s ago)";
+    }
+    if (cache.refreshing() && cache.get()) stamp += "  refreshing...";
+    return text(stamp) | dim;
+}
+
+// Renders the latest partition snapshot; never runs sinfo itself
+inline Component clusterView(const PartitionSnapshot& cache) {
+    return Renderer([&cache] {
+        auto partitions = cache.get();
+        if (!partitions) {
+            return vbox({text("Loading partitions...") | dim | center}) | border;
+        }
 
         std::vector<Element> rows;
 
@@ -38,27 +64,38 @@ inline Component clusterView() {
         rows.push_back(
             hbox({
                 text("PARTITION") | bold | size(WIDTH, EQUAL, 15),
-                text("NODES") | bold | size(WIDTH, EQUAL, 8),
+                text("NODES") | bold | size(WIDTH, EQUAL, 7),
                 text("IDLE") | bold | color(Color::Green) | size(WIDTH, EQUAL, 6),
                 text("MIX") | bold | color(Color::Yellow) | size(WIDTH, EQUAL, 6),
                 text("ALLOC") | bold | color(Color::Red) | size(WIDTH, EQUAL, 6),
                 text("DOWN") | bold | color(Color::GrayDark) | size(WIDTH, EQUAL, 6),
+                text("FREE CPU") | bold | size(WIDTH, EQUAL, 10),
+                text("FREE GPU") | bold | size(WIDTH, EQUAL, 10),
+                text("PEND") | bold | size(WIDTH, EQUAL, 6),
                 text("LIMIT") | bold | size(WIDTH, EQUAL, 12),
                 text("USAGE") | bold,
             })
         );
         rows.push_back(separator());
 
-        for (const auto& p : partitions) {
+        for (const auto& p : *partitions) {
             Color state_color = (p.state == "up") ? Color::Green : Color::Red;
 
+            std::string free_gpu = p.gpus_total > 0
+                ? std::to_string(p.gpus_total - p.gpus_used) + "/" + std::to_string(p.gpus_total)
+                : "-";
+
             rows.push_back(hbox({
                 text(p.name) | color(state_color) | size(WIDTH, EQUAL, 15),
-                text(std::to_string(p.nodes_total)) | size(WIDTH, EQUAL, 8),
+                text(std::to_string(p.nodes_total)) | size(WIDTH, EQUAL, 7),
                 text(std::to_string(p.nodes_idle)) | color(Color::Green) | size(WIDTH, EQUAL, 6),
                 text(std::to_string(p.nodes_mix)) | color(Color::Yellow) | size(WIDTH, EQUAL, 6),
                 text(std::to_string(p.nodes_alloc)) | color(Color::Red) | size(WIDTH, EQUAL, 6),
                 text(std::to_string(p.nodes_down)) | color(Color::GrayDark) | size(WIDTH, EQUAL, 6),
+                text(std::to_string(p.cpus_idle)) | size(WIDTH, EQUAL, 10),
+                text(free_gpu) | size(WIDTH, EQUAL, 10),
+                text(std::to_string(p.pending_jobs)) |
+                    color(p.pending_jobs > 0 ? Color::Yellow : Color::GrayDark) | size(WIDTH, EQUAL, 6),
                 text(p.timelimit) | dim | size(WIDTH, EQUAL, 12),
                 renderPartitionBar(p),
             }));
@@ -72,6 +109,8 @@ inline Component clusterView() {
             text("=") | color(Color::Yellow), text(" mix  ") | dim,
             text("=") | color(Color::Red), text(" alloc  ") | dim,
             text("x") | color(Color::GrayDark), text(" down") | dim,
+            filler(),
+            snapshotStamp(cache),
         }));
 
         return vbox(rows) | border;
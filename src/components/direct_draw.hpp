@@ -0,0 +1,98 @@
+#pragma once
+
+#include <ftxui/screen/box.hpp>
+#include <ftxui/screen/color.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+namespace ui {
+using namespace ftxui;
+
+// Writes glyphs straight into the Screen pixel buffer, clipped to a box.
+// Used by custom Nodes that draw large grids without one Element per cell.
+struct DirectDraw {
+    Screen& screen;
+    Box clip;
+
+    DirectDraw(Screen& s, const Box& box) : screen(s), clip(Box::Intersection(box, s.stencil)) {}
+
+    bool empty() const { return clip.x_min > clip.x_max || clip.y_min > clip.y_max; }
+    bool rowVisible(int y) const { return y >= clip.y_min && y <= clip.y_max; }
+
+    void put(int x, int y, const char* glyph, Color fg = Color::Default, bool bold = false) {
+        if (x < clip.x_min || x > clip.x_max || y < clip.y_min || y > clip.y_max) return;
+        Pixel& p = screen.PixelAt(x, y);
+        p.character = glyph;
+        p.foreground_color = fg;
+        p.bold = bold;
+    }
+
+    // One cell per UTF-8 code point (only narrow glyphs are drawn this way).
+    // Returns the column after the last glyph; stops past the clip edge.
+    int text(int x, int y, std::string_view str, Color fg = Color::Default, bool bold = false) {
+        if (!rowVisible(y)) return x + (int)str.size();
+        char glyph[5];
+        for (size_t i = 0; i < str.size() && x <= clip.x_max; ++x) {
+            size_t len = glyphLength(str, i);
+            str.copy(glyph, len, i);
+            glyph[len] = '\0';
+            put(x, y, glyph, fg, bold);
+            i += len;
+        }
+        return x;
+    }
+
+    // Arbitrary text (log lines) starting `skip` code points in. Control
+    // characters are shown as spaces so raw escapes never reach the terminal.
+    // Returns true when the line continues past the clip edge.
+    bool line(int x, int y, std::string_view str, size_t skip, Color fg = Color::Default) {
+        if (!rowVisible(y)) return false;
+        size_t i = 0;
+        for (; i < str.size() && skip > 0; --skip) i += glyphLength(str, i);
+
+        char glyph[5];
+        for (; i < str.size(); ++x) {
+            if (x > clip.x_max) return true;
+            size_t len = glyphLength(str, i);
+            if ((unsigned char)str[i] < 0x20 || str[i] == 0x7f) {
+                put(x, y, " ", fg);
+            } else {
+                str.copy(glyph, len, i);
+                glyph[len] = '\0';
+                put(x, y, glyph, fg);
+            }
+            i += len;
+        }
+        return false;
+    }
+
+    // Swap colours of `width` cells (search matches)
+    void invert(int x, int y, int width) {
+        for (int i = 0; i < width; ++i) {
+            int cx = x + i;
+            if (cx < clip.x_min || cx > clip.x_max || !rowVisible(y)) continue;
+            screen.PixelAt(cx, y).inverted = true;
+        }
+    }
+
+    // Cells taken by a string drawn with text() or line()
+    static int columns(std::string_view str) {
+        int n = 0;
+        for (size_t i = 0; i < str.size(); i += glyphLength(str, i)) n++;
+        return n;
+    }
+
+private:
+    static size_t glyphLength(std::string_view str, size_t i) {
+        size_t len = 1;
+        unsigned char c = str[i];
+        if (c >= 0xF0) len = 4;
+        else if (c >= 0xE0) len = 3;
+        else if (c >= 0xC0) len = 2;
+        return std::min(len, str.size() - i);
+    }
+};
+
+}
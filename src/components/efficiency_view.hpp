@@ -0,0 +1,219 @@
+#pragma once
+
+#include <ftxui/component/component.hpp>
+#include <ftxui/dom/elements.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <numeric>
+#include "../api/efficiency.hpp"
+#include "../api/snapshot_cache.hpp"
+#include "history_view.hpp"
+
+namespace ui {
+using namespace ftxui;
+
+// Efficiency is computed over a longer window than the history view shows
+constexpr int EFFICIENCY_DAYS = 30;
+
+// Ratio cell: wasted (red), loose (yellow), well sized (green)
+inline Element efficiencyCell(float ratio, int width) {
+    if (ratio < 0) return text("-") | dim | size(WIDTH, EQUAL, width);
+    int percent = (int)(ratio * 100 + 0.5f);
+    Color fg = ratio < 0.5f ? Color::Red : ratio < 0.8f ? Color::Yellow : Color::Green;
+    return text(std::to_string(percent) + "%") | color(fg) | size(WIDTH, EQUAL, width);
+}
+
+inline std::string sbatchLine(int64_t mem, int32_t cpus, int64_t time) {
+    std::string line;
+    if (mem > 0) line += "--mem=" + api::history::slurmMemory(mem) + " ";
+    if (cpus > 0) line += "-c " + std::to_string(cpus) + " ";
+    if (time > 0) line += "--time=" + api::history::slurmTime(time);
+    return line.empty() ? "-" : line;
+}
+
+// Groups of one store table, most jobs first; built on a worker
+struct EfficiencyGroups {
+    api::EfficiencyTable table;
+    std::vector<size_t> order;
+    uint64_t version = 0;  // Store version of the table
+    bool by_partition = false;
+
+    EfficiencyGroups(std::shared_ptr<const api::HistoryTable> history, uint64_t v, bool partition)
+        : version(v), by_partition(partition) {
+        auto by = partition ? api::HistoryTable::Partition : api::HistoryTable::Name;
+        int64_t since = (int64_t)std::time(nullptr) - (int64_t)EFFICIENCY_DAYS * 86400;
+        table = api::EfficiencyTable(*history, by, since);
+        const auto& g = table.groups;
+        order.resize(g.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return g[a].jobs > g[b].jobs; });
+    }
+};
+
+inline std::string plural(int count, const std::string& noun) {
+    return std::to_string(count) + " " + noun + (count == 1 ? "" : "s");
+}
+
+// CPU, memory and time-limit efficiency of finished jobs per job name or
+// partition, with the --mem, -c and --time the next run should ask for
+inline Component efficiencyView(std::function<void()> on_close, std::function<void()> on_update = {}) {
+    auto& store = api::HistoryStore::instance();
+
+    struct State {
+        std::atomic<bool> by_partition{false};
+        std::shared_ptr<const EfficiencyGroups> shown = std::make_shared<EfficiencyGroups>(
+            std::make_shared<api::HistoryTable>(), UINT64_MAX, false);
+        size_t selected = 0;
+        int top = 0;
+    };
+    auto state = std::make_shared<State>();
+    auto builds = std::make_shared<api::SnapshotCache<EfficiencyGroups>>(
+        [&store, state] {
+            uint64_t version = store.version();  // Read first: a table published meanwhile is grouped again
+            return EfficiencyGroups(store.table(), version, state->by_partition);
+        },
+        std::chrono::seconds(0));
+    static constexpr int PAGE = 16;
+
+    builds->refreshAsync(on_update);
+    store.syncIfStale(EFFICIENCY_DAYS, on_update);
+
+    auto full_view = Renderer([=, &store] {
+        // The latest grouping is swapped in; another is asked for when the store or the key changed
+        auto latest = builds->get();
+        if (latest && latest != state->shown) {
+            state->shown = latest;
+            state->selected = std::min(state->selected, std::max<size_t>(latest->order.size(), 1) - 1);
+        }
+        if (!builds->refreshing() && latest &&
+            (latest->version != store.version() || latest->by_partition != state->by_partition))
+            builds->refreshAsync(on_update);
+        const auto& shown = *state->shown;
+        const auto& groups = shown.table.groups;
+        int count = (int)groups.size();
+        int selected = (int)state->selected;
+        if (selected < state->top) state->top = selected;
+        if (selected >= state->top + PAGE) state->top = selected - PAGE + 1;
+
+        Elements rows;
+        for (int i = state->top; i < std::min(count, state->top + PAGE); ++i) {
+            const auto& g = groups[shown.order[i]];
+            bool is_selected = i == selected;
+            std::string key = g.key.empty() ? "(none)" : g.key;
+            if (key.size() > 20) key = key.substr(0, 17) + "...";
+            auto row = hbox({
+                text(is_selected ? "▶ " : "  ") | color(Color::Yellow),
+                text(key) | size(WIDTH, EQUAL, 22),
+                text(std::to_string(g.jobs)) | size(WIDTH, EQUAL, 6),
+                efficiencyCell(g.cpu_eff, 7),
+                efficiencyCell(g.mem_eff, 7),
+                efficiencyCell(g.time_use, 7),
+                text(sbatchLine(g.mem, g.cpus, g.time)) | color(Color::Cyan),
+            });
+            rows.push_back(is_selected ? row | inverted : row);
+        }
+        if (rows.empty())
+            rows.push_back(text(latest ? "  no finished job in the last 30 days" : "  loading...") | dim);
+
+        // Selected group: current request against the recommendation
+        Element detail = text("");
+        if (count > 0) {
+            const auto& g = groups[shown.order[selected]];
+            Elements warnings;
+            if (g.out_of_memory > 0)
+                warnings.push_back(text("  " + std::to_string(g.out_of_memory) + " out of memory") | color(Color::Red));
+            if (g.timeouts > 0)
+                warnings.push_back(text("  " + std::to_string(g.timeouts) + " timed out") | color(Color::Red));
+            detail = vbox({
+                hbox({text("  now:         ") | dim, text(sbatchLine(g.req_mem, g.req_cpus, g.req_time))}),
+                hbox({text("  recommended: ") | dim, text(sbatchLine(g.mem, g.cpus, g.time)) | bold | color(Color::Cyan),
+                      hbox(warnings)}),
+                text("  from " + std::to_string(g.completed) + "/" + std::to_string(g.jobs) +
+                     " completed jobs (p95 + margin); --mem per node and -c per task, for " + plural(g.tasks, "task") +
+                     " on " + plural(g.nodes, "node")) | dim,
+            });
+        }
+
+        return vbox({
+            text("═══════ JOB EFFICIENCY (last 30 days) ═══════") | bold | center | color(Color::Cyan),
+            separator(),
+            hbox({
+                text(state->by_partition ? " name " : "[NAME]") | (state->by_partition ? dim : bold),
+                text(" "),
+                text(state->by_partition ? "[PARTITION]" : " partition ") | (state->by_partition ? bold : dim),
+            }) | color(Color::Cyan) | center,
+            hbox({
+                text(std::to_string(count) + " groups") | dim,
+                filler(),
+                (store.syncing() ? text("syncing with sacct...") | color(Color::Green) : text("")),
+            }),
+            separator(),
+            hbox({
+                text("  "),
+                text(state->by_partition ? "PARTITION" : "NAME") | bold | size(WIDTH, EQUAL, 22),
+                text("JOBS") | bold | size(WIDTH, EQUAL, 6),
+                text("CPU") | bold | size(WIDTH, EQUAL, 7),
+                text("MEM") | bold | size(WIDTH, EQUAL, 7),
+                text("TIME") | bold | size(WIDTH, EQUAL, 7),
+                text("RECOMMENDED") | bold,
+            }),
+            separator(),
+            vbox(rows) | size(HEIGHT, EQUAL, PAGE),
+            separator(),
+            detail,
+            separator(),
+            hbox({
+                text("Tab") | bold | color(Color::Yellow),
+                text(": name/partition  ") | dim,
+                text("↑↓") | bold | color(Color::Yellow),
+                text(": select  ") | dim,
+                text("r") | bold | color(Color::Yellow),
+                text(": refresh  ") | dim,
+                text("Esc") | bold | color(Color::Yellow),
+                text(": close") | dim,
+            }) | center,
+        }) | border | size(WIDTH, LESS_THAN, 110);
+    });
+
+    return CatchEvent(full_view, [=, &store](Event e) {
+        size_t count = state->shown->table.size();
+        auto select = [&](long row) {
+            if (count == 0) return;
+            state->selected = (size_t)std::clamp<long>(row, 0, (long)count - 1);
+        };
+        long selected = (long)state->selected;
+
+        if (e.is_mouse()) {
+            if (e.mouse().button == Mouse::WheelDown) { select(selected + 3); return true; }
+            if (e.mouse().button == Mouse::WheelUp) { select(selected - 3); return true; }
+            return false;
+        }
+        if (e == Event::ArrowDown) { select(selected + 1); return true; }
+        if (e == Event::ArrowUp) { select(selected - 1); return true; }
+        if (e == Event::PageDown) { select(selected + PAGE); return true; }
+        if (e == Event::PageUp) { select(selected - PAGE); return true; }
+        if (e == Event::Home) { select(0); return true; }
+        if (e == Event::End) { select((long)count - 1); return true; }
+
+        if (e == Event::Tab || e == Event::ArrowLeft || e == Event::ArrowRight) {
+            state->by_partition = !state->by_partition;
+            state->selected = 0;
+            state->top = 0;
+            builds->refreshAsync(on_update);
+            return true;
+        }
+        if (e == Event::Character('r') || e == Event::Character('R')) {
+            store.syncAsync(EFFICIENCY_DAYS, on_update);
+            return true;
+        }
+        if (e == Event::Escape || e == Event::Return) {
+            on_close();
+            return true;
+        }
+        return false;
+    });
+}
+
+}
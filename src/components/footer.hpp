@@ -26,18 +26,33 @@ inline Element footer() {
         text("s") | bold | color(Color::Yellow),
         text(":Sort") | dim,
         text(" "),
+        text("f") | bold | color(Color::Yellow),
+        text(":Filter") | dim,
+        text(" "),
         text("p") | bold | color(Color::Yellow),
         text(":Parts") | dim,
         text(" "),
+        text("n") | bold | color(Color::Yellow),
+        text(":Nodes") | dim,
+        text(" "),
         text("d") | bold | color(Color::Yellow),
         text(":Debug") | dim,
         text(" "),
         text("l") | bold | color(Color::Yellow),
         text(":Logs") | dim,
         text(" "),
+        text("m") | bold | color(Color::Yellow),
+        text(":Multi") | dim,
+        text(" "),
+        text("/") | bold | color(Color::Yellow),
+        text(":Grep") | dim,
+        text(" "),
         text("a") | bold | color(Color::Yellow),
         text(":History") | dim,
         text(" "),
+        text("e") | bold | color(Color::Yellow),
+        text(":Efficiency") | dim,
+        text(" "),
         text("u") | bold | color(Color::Yellow),
         text(":Quota") | dim,
         text(" "),
@@ -53,22 +68,30 @@ inline Component helpModal(std::function<void()> on_close) {
             text("Navigation") | bold | color(Color::Yellow),
             hbox({text("  Up / Down       ") | color(Color::Cyan), text("Navigate job list")}),
             hbox({text("  Mouse wheel     ") | color(Color::Cyan), text("Scroll details/logs")}),
+            hbox({text("  PgUp / PgDn     ") | color(Color::Cyan), text("Page through the node grid")}),
+            hbox({text("  g               ") | color(Color::Cyan), text("Jump to node (by name)")}),
             text(""),
             text("Actions") | bold | color(Color::Yellow),
             hbox({text("  r               ") | color(Color::Cyan), text("Refresh jobs")}),
             hbox({text("  c               ") | color(Color::Cyan), text("Cancel job (with confirmation)")}),
             hbox({text("  y               ") | color(Color::Cyan), text("Copy job ID to clipboard (yank)")}),
             hbox({text("  s               ") | color(Color::Cyan), text("Sort jobs (cycle: ID/Name/Entry)")}),
+            hbox({text("  f               ") | color(Color::Cyan), text("Filter jobs (user:, account:, partition:, state:, node:)")}),
             text(""),
             text("Views") | bold | color(Color::Yellow),
             hbox({text("  p               ") | color(Color::Cyan), text("Partitions view (sinfo)")}),
+            hbox({text("  n               ") | color(Color::Cyan), text("Cluster node heatmap (scontrol show node)")}),
             hbox({text("  d               ") | color(Color::Cyan), text("Debug view (scontrol show job)")}),
-            hbox({text("  l               ") | color(Color::Cyan), text("Logs view (stdout/stderr, scrollable)")}),
+            hbox({text("  l               ") | color(Color::Cyan), text("Logs view (stdout/stderr, f: follow)")}),
+            hbox({text("  m               ") | color(Color::Cyan), text("Live logs of the whole array/sweep (Tab: one file)")}),
+            hbox({text("  /               ") | color(Color::Cyan), text("Grep every log of the array/sweep, finished tasks included")}),
             hbox({text("  a               ") | color(Color::Cyan), text("History (sacct) - filter with ←→")}),
+            hbox({text("  e               ") | color(Color::Cyan), text("Efficiency and --mem/-c/--time recommendations")}),
             hbox({text("  u               ") | color(Color::Cyan), text("User quota (sacctmgr limits)")}),
             text(""),
             text("Other") | bold | color(Color::Yellow),
             hbox({text("  h / ?           ") | color(Color::Cyan), text("Show this help")}),
+            hbox({text("  t               ") | color(Color::Cyan), text("Frame timings overlay (build/layout/draw)")}),
             hbox({text("  q / Escape      ") | color(Color::Cyan), text("Quit application")}),
             text(""),
             text("════════════════════════════════════════════════") | color(Color::Cyan),
@@ -0,0 +1,335 @@
+#pragma once
+
+#include <ftxui/component/event.hpp>
+#include <ftxui/dom/elements.hpp>
+#include <ftxui/dom/node.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ui {
+using namespace ftxui;
+
+using FrameClock = std::chrono::steady_clock;
+
+// Timings of the last built frame (microseconds) and running counters
+struct FrameStats {
+    long long build_us = 0;      // Component tree -> Element tree
+    long long layout_us = 0;     // ComputeRequirement + SetBox (+ flexbox iterations)
+    long long draw_us = 0;       // Element tree -> pixel buffer
+    size_t bytes_written = 0;    // Terminal output of the previous frame
+    int frames_built = 0;
+    int frames_reused = 0;
+    int events_coalesced = 0;
+    double fps = 0.0;
+};
+
+// Forwards everything to the wrapped streambuf and counts the bytes.
+// FTXUI writes each frame to std::cout, so this measures terminal traffic.
+class CountingStreambuf : public std::streambuf {
+public:
+    explicit CountingStreambuf(std::streambuf* target) : target_(target) {}
+
+    size_t take() {
+        size_t n = count_;
+        count_ = 0;
+        return n;
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+        count_++;
+        return target_->sputc(traits_type::to_char_type(ch));
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        count_ += n;
+        return target_->sputn(s, n);
+    }
+
+    int sync() override { return target_->pubsync(); }
+
+private:
+    std::streambuf* target_;
+    size_t count_ = 0;
+};
+
+// Frame instrumentation, dirty tracking and redraw throttling for the main loop.
+//
+// - frame() rebuilds the element tree only when something changed (input event,
+//   snapshot version, status text, terminal size). Otherwise the pixels of the
+//   previous frame are copied back, skipping build, layout and draw entirely.
+// - onEvent() coalesces bursts of mouse wheel / motion events: at most one
+//   rebuild per min_interval, with a deferred Event::Custom for the last one.
+class FrameProfiler {
+public:
+    FrameProfiler(std::chrono::milliseconds min_interval, std::function<void()> post_redraw)
+        : min_interval_(min_interval),
+          post_redraw_(std::move(post_redraw)),
+          counter_(std::cout.rdbuf()) {
+        original_buf_ = std::cout.rdbuf(&counter_);
+        timer_ = std::thread([this] { timerLoop(); });
+    }
+
+    ~FrameProfiler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        timer_.join();
+        std::cout.rdbuf(original_buf_);
+    }
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    void invalidate() { dirty_ = true; }
+
+    void toggleOverlay() {
+        show_overlay_ = !show_overlay_;
+        dirty_ = true;
+    }
+
+    const FrameStats& stats() const { return stats_; }
+
+    // Inspect an event before the component tree handles it. Never consumes it.
+    void onEvent(Event& e) {
+        if (e == Event::Custom) {
+            // Deferred redraw of a coalesced burst (other Custom events leave the frame as is)
+            if (pending_) {
+                pending_ = false;
+                dirty_ = true;
+            }
+            return;
+        }
+
+        bool throttled = e.is_mouse() &&
+                         (e.mouse().button == Mouse::WheelUp ||
+                          e.mouse().button == Mouse::WheelDown ||
+                          e.mouse().button == Mouse::None);
+        if (!throttled) {
+            dirty_ = true;
+            return;
+        }
+
+        auto next_allowed = last_build_ + min_interval_;
+        if (FrameClock::now() >= next_allowed) {
+            dirty_ = true;
+        } else {
+            pending_ = true;
+            stats_.events_coalesced++;
+            scheduleRedraw(next_allowed);
+        }
+    }
+
+    // Wrap the frame builder. `version` is bumped by the caller whenever the data
+    // displayed (job snapshot, selection) changes outside of input events;
+    // `status` is text that changes on its own (message, countdown).
+    Element frame(const std::function<Element()>& build, int dimx, int dimy, uint64_t version,
+                  const std::string& status = {}) {
+        if (dimx != dimx_ || dimy != dimy_ || version != version_ || status != status_ || !cache_.valid) {
+            dirty_ = true;
+        }
+        dimx_ = dimx;
+        dimy_ = dimy;
+        version_ = version;
+        status_ = status;
+
+        if (!dirty_) {
+            stats_.frames_reused++;
+            return std::make_shared<FrameNode>(nullptr, this);
+        }
+
+        dirty_ = false;
+        last_build_ = FrameClock::now();
+        Element root = build();
+        stats_.build_us = elapsedUs(last_build_);
+        stats_.layout_us = 0;
+        stats_.draw_us = 0;
+        stats_.frames_built++;
+        return std::make_shared<FrameNode>(std::move(root), this);
+    }
+
+private:
+    // Pixels and layout of the last built frame
+    struct FrameCache {
+        bool valid = false;
+        Box box;
+        Requirement requirement;
+        std::vector<Pixel> pixels;
+    };
+
+    // Root node: times layout/draw of a freshly built tree and snapshots its
+    // pixels, or replays the snapshot when there is no child (reused frame).
+    class FrameNode : public Node {
+    public:
+        FrameNode(Element child, FrameProfiler* profiler)
+            : Node(child ? Elements{std::move(child)} : Elements{}), profiler_(profiler) {}
+
+        void ComputeRequirement() override {
+            if (children_.empty()) {
+                requirement_ = profiler_->cache_.requirement;
+                return;
+            }
+            auto start = FrameClock::now();
+            children_[0]->ComputeRequirement();
+            requirement_ = children_[0]->requirement();
+            profiler_->stats_.layout_us += elapsedUs(start);
+        }
+
+        void SetBox(Box box) override {
+            Node::SetBox(box);
+            if (children_.empty()) return;
+            auto start = FrameClock::now();
+            children_[0]->SetBox(box);
+            profiler_->stats_.layout_us += elapsedUs(start);
+        }
+
+        void Check(Status* status) override {
+            if (children_.empty()) return;
+            auto start = FrameClock::now();
+            Node::Check(status);
+            profiler_->stats_.layout_us += elapsedUs(start);
+        }
+
+        void Render(Screen& screen) override {
+            auto& cache = profiler_->cache_;
+            int width = box_.x_max - box_.x_min + 1;
+            int height = box_.y_max - box_.y_min + 1;
+
+            if (children_.empty()) {
+                if (!sameBox(cache.box, box_)) {
+                    // Screen changed under us: the next frame must be rebuilt
+                    cache.valid = false;
+                    profiler_->scheduleRedraw(FrameClock::now());
+                } else {
+                    for (int y = 0; y < height; ++y)
+                        for (int x = 0; x < width; ++x)
+                            screen.PixelAt(box_.x_min + x, box_.y_min + y) = cache.pixels[y * width + x];
+                }
+            } else {
+                auto start = FrameClock::now();
+                children_[0]->Render(screen);
+                profiler_->stats_.draw_us = elapsedUs(start);
+
+                cache.box = box_;
+                cache.requirement = requirement_;
+                cache.pixels.resize(std::max(0, width * height));
+                for (int y = 0; y < height; ++y)
+                    for (int x = 0; x < width; ++x)
+                        cache.pixels[y * width + x] = screen.PixelAt(box_.x_min + x, box_.y_min + y);
+                cache.valid = true;
+            }
+
+            profiler_->recordFrame();
+            if (profiler_->show_overlay_) profiler_->drawOverlay(screen, box_);
+        }
+
+    private:
+        static bool sameBox(const Box& a, const Box& b) {
+            return a.x_min == b.x_min && a.x_max == b.x_max &&
+                   a.y_min == b.y_min && a.y_max == b.y_max;
+        }
+
+        FrameProfiler* profiler_;
+    };
+
+    static long long elapsedUs(FrameClock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(FrameClock::now() - start).count();
+    }
+
+    void recordFrame() {
+        stats_.bytes_written = counter_.take();
+        auto now = FrameClock::now();
+        if (last_draw_ != FrameClock::time_point{}) {
+            double dt = std::chrono::duration<double>(now - last_draw_).count();
+            if (dt > 0) stats_.fps = stats_.fps == 0.0 ? 1.0 / dt : 0.9 * stats_.fps + 0.1 / dt;
+        }
+        last_draw_ = now;
+    }
+
+    // Stats are painted after the cached pixels so they stay live on reused frames
+    void drawOverlay(Screen& screen, const Box& box) {
+        char line[160];
+        std::snprintf(line, sizeof(line),
+                      " build %.2fms  layout %.2fms  draw %.2fms  out %.1fKB  %.0ffps  built %d  reused %d  coalesced %d ",
+                      stats_.build_us / 1000.0, stats_.layout_us / 1000.0, stats_.draw_us / 1000.0,
+                      stats_.bytes_written / 1024.0, stats_.fps,
+                      stats_.frames_built, stats_.frames_reused, stats_.events_coalesced);
+
+        int x = box.x_min;
+        for (const char* c = line; *c && x <= box.x_max; ++c, ++x) {
+            Pixel& p = screen.PixelAt(x, box.y_min);
+            p.character = std::string(1, *c);
+            p.foreground_color = Color::Black;
+            p.background_color = Color::Yellow;
+        }
+    }
+
+    void scheduleRedraw(FrameClock::time_point at) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (wake_pending_) return;
+            wake_pending_ = true;
+            wake_at_ = at;
+        }
+        cv_.notify_one();
+    }
+
+    void timerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            if (!wake_pending_) {
+                cv_.wait(lock);
+                continue;
+            }
+            if (cv_.wait_until(lock, wake_at_) == std::cv_status::timeout && !stop_) {
+                wake_pending_ = false;
+                lock.unlock();
+                post_redraw_();
+                lock.lock();
+            }
+        }
+    }
+
+    std::chrono::milliseconds min_interval_;
+    std::function<void()> post_redraw_;
+
+    // UI thread state
+    FrameStats stats_;
+    FrameCache cache_;
+    bool dirty_ = true;
+    bool pending_ = false;
+    bool show_overlay_ = false;
+    int dimx_ = 0;
+    int dimy_ = 0;
+    uint64_t version_ = 0;
+    std::string status_;
+    FrameClock::time_point last_build_;
+    FrameClock::time_point last_draw_;
+
+    CountingStreambuf counter_;
+    std::streambuf* original_buf_ = nullptr;
+
+    // Deferred redraw timer
+    std::thread timer_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    FrameClock::time_point wake_at_;
+    bool wake_pending_ = false;
+    bool stop_ = false;
+};
+
+}
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <ftxui/component/component.hpp>
+#include <ftxui/dom/elements.hpp>
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include "../api/slurmjobs.hpp"
+#include "../api/log_grep.hpp"
+#include "../api/snapshot_cache.hpp"
+#include "direct_draw.hpp"
+#include "viewport.hpp"
+
+namespace ui {
+using namespace ftxui;
+
+// A file searched by the grep view and the job it belongs to
+struct GrepTarget {
+    api::JobLogs job;
+    bool stderr_file = false;
+};
+
+// stdout of every job, and stderr when it goes elsewhere; labelled like the merged view
+inline std::vector<GrepTarget> grepTargets(const std::vector<api::JobLogs>& jobs) {
+    std::vector<GrepTarget> targets;
+    std::set<std::string> seen;
+    for (const auto& job : jobs) {
+        for (bool is_stderr : {false, true}) {
+            const std::string& path = is_stderr ? job.stderr_path : job.stdout_path;
+            if (path.empty() || path == "(null)" || !seen.insert(path).second) continue;
+            targets.push_back({job, is_stderr});
+        }
+    }
+    return targets;
+}
+
+// Files of a job set as the grep view searches them, and the set's title
+struct GrepSet {
+    std::string title;
+    std::vector<GrepTarget> targets;
+    std::vector<api::LogGrep::File> files;  // One per target
+
+    GrepSet(const std::string& job_id, const std::vector<api::JobLogs>& jobs)
+        : title(job_id), targets(grepTargets(jobs)) {
+        if (!jobs.empty()) title = jobs[0].array_task.empty() ? jobs[0].name : "array " + job_id.substr(0, job_id.find('_'));
+        for (const auto& t : targets)
+            files.push_back({(t.job.array_task.empty() ? t.job.id : t.job.array_task) + (t.stderr_file ? " err" : ""),
+                             t.stderr_file ? t.job.stderr_path : t.job.stdout_path});
+    }
+};
+
+// Selected hit of the list. The selection follows its hit (file, line) while
+// results of earlier files are inserted above it.
+struct GrepCursor : LineViewport {
+    size_t selected = 0;
+    bool anchored = false;
+    size_t file = 0;
+    uint64_t line = 0;
+};
+
+// Hits drawn straight into the screen; only the visible rows are visited
+class GrepRows : public Node {
+public:
+    static constexpr int MAX_ROWS = 24;
+    static constexpr int MAX_COLUMNS = 120;
+    static constexpr int MAX_LABEL = 12;
+
+    GrepRows(const api::LogGrep& grep, GrepCursor* cursor) : grep_(grep), cursor_(cursor) {
+        for (const auto& f : grep_.files()) label_width_ = std::max(label_width_, (int)f.label.size());
+        label_width_ = std::min(label_width_, MAX_LABEL);
+    }
+
+    void ComputeRequirement() override {
+        count_ = grep_.hitCount();
+        requirement_.min_x = MAX_COLUMNS;
+        requirement_.min_y = (int)std::min<size_t>(std::max<size_t>(count_, 1), MAX_ROWS);
+        requirement_.flex_grow_x = 1;
+        requirement_.flex_grow_y = 1;
+        requirement_.flex_shrink_x = 1;
+        requirement_.flex_shrink_y = 1;
+    }
+
+    // Scrolls just enough to keep the selection on screen
+    void SetBox(Box box) override {
+        Node::SetBox(box);
+        cursor_->content = (int)count_;
+        cursor_->page = box.y_max - box.y_min + 1;
+        int selected = (int)cursor_->selected;
+        if (selected < cursor_->top) cursor_->top = selected;
+        if (selected >= cursor_->top + cursor_->page) cursor_->top = selected - cursor_->page + 1;
+        cursor_->scrollTo(cursor_->top);
+    }
+
+    void Render(Screen& screen) override {
+        DirectDraw draw(screen, box_);
+        if (draw.empty()) return;
+
+        const std::string& needle = grep_.needle();
+        char number[24];
+        grep_.visit((size_t)cursor_->top, (size_t)cursor_->page, [&](size_t row, size_t file, const api::LogGrep::Hit& hit) {
+            int y = box_.y_min + (int)row - cursor_->top;
+            bool selected = row == cursor_->selected;
+            draw.put(box_.x_min, y, selected ? "▶" : " ", Color::Yellow, true);
+
+            std::string label = grep_.files()[file].label.substr(0, MAX_LABEL);
+            label.resize(label_width_, ' ');
+            int x = draw.text(box_.x_min + 2, y, label, Color::Magenta, selected);
+            std::snprintf(number, sizeof(number), " %8llu ", (unsigned long long)hit.line + 1);
+            x = draw.text(x, y, number, Color::GrayDark);
+            draw.text(x, y, "│ ", Color::GrayDark);
+            x += 2;
+
+            draw.line(x, y, hit.excerpt, 0, selected ? Color(Color::White) : Color(Color::Default));
+            std::string_view excerpt = hit.excerpt;
+            for (size_t pos = excerpt.find(needle); pos != std::string_view::npos; pos = excerpt.find(needle, pos + 1))
+                draw.invert(x + DirectDraw::columns(excerpt.substr(0, pos)), y, DirectDraw::columns(needle));
+        });
+    }
+
+private:
+    const api::LogGrep& grep_;
+    GrepCursor* cursor_;
+    size_t count_ = 0;
+    int label_width_ = 4;
+};
+
+// Grep across the logs of every job of an array or sweep, finished ones
+// included. The pattern is typed first; hits are listed as files are scanned
+// and Enter opens the log at the selected line (on_open). `user` owns the
+// job (the current user when empty). The job set is resolved (sacct, then
+// squeue) on a worker while the pattern is typed; a search asked for before
+// it is known starts when it is.
+inline Component grepView(const std::string& job_id, const std::string& user,
+                          std::function<void(const GrepTarget&, uint64_t line, const std::string& needle)> on_open,
+                          std::function<void()> on_close, std::function<void()> on_update = {}) {
+    // Dropped with the component: waits for sacct without calling on_update
+    auto sets = std::make_shared<api::SnapshotCache<GrepSet>>(
+        [job_id, user] { return GrepSet(job_id, api::slurm::getJobSetLogs(job_id, user)); }, std::chrono::hours(24));
+    sets->refreshAsync(on_update);
+
+    struct State {
+        bool editing = true;
+        bool pending = false;  // Enter pressed before the set was known
+        std::string input;
+        std::shared_ptr<const GrepSet> set;  // Null until resolved
+        std::unique_ptr<api::LogGrep> grep;  // Dropped with the view: stops the workers
+        GrepCursor cursor;
+    };
+    auto state = std::make_shared<State>();
+
+    auto search = [=] {
+        state->grep.reset();  // Joins the previous scan first
+        state->cursor = GrepCursor{};
+        state->grep = std::make_unique<api::LogGrep>(state->set->files, state->input, api::LogGrep::DEFAULT_IO_LIMIT,
+                                                     on_update);
+    };
+    // Takes the resolved set, and runs the search waiting for it
+    auto load = [=] {
+        if (state->set) return;
+        state->set = sets->get();
+        if (state->set && state->pending) {
+            state->pending = false;
+            search();
+        }
+    };
+
+    // Select `row` and remember which hit it is
+    auto select = [=](size_t row) {
+        auto& c = state->cursor;
+        size_t count = state->grep ? state->grep->hitCount() : 0;
+        if (count == 0) return;
+        c.selected = std::min(row, count - 1);
+        state->grep->visit(c.selected, 1, [&](size_t, size_t file, const api::LogGrep::Hit& hit) {
+            c.file = file;
+            c.line = hit.line;
+        });
+        c.anchored = true;
+    };
+
+    auto full_view = Renderer([=] {
+        load();
+        auto* grep = state->grep.get();
+        auto& c = state->cursor;
+        if (grep && c.anchored) c.selected = grep->rowOf(c.file, c.line);
+        else if (grep) select(0);
+
+        Element prompt;
+        if (state->editing) {
+            prompt = text("/" + state->input + "█") | bold | color(Color::Yellow);
+        } else if (grep) {
+            prompt = text("/" + grep->needle()) | bold | color(Color::Yellow);
+        } else {
+            prompt = text("");
+        }
+
+        Element status = text("");
+        if (!state->set) {
+            status = text("finding the logs of the set (sacct)...") | dim;
+        } else if (state->set->files.empty()) {
+            status = text("no log file found") | dim;
+        } else if (grep) {
+            size_t total = grep->files().size();
+            size_t missing = grep->missingCount();
+            std::string label = std::to_string(grep->hitCount()) + " lines in " + std::to_string(grep->filesMatched()) +
+                                "/" + std::to_string(total) + " files";
+            status = hbox({
+                text(label) | color(Color::Cyan),
+                (missing > 0 ? text("  " + std::to_string(missing) + " missing") | color(Color::Red) : text("")),
+                (grep->done() ? text("")
+                              : text("  scanning " + std::to_string(100 * grep->filesDone() / total) + "%") |
+                                    bold | color(Color::Green)),
+            });
+        } else {
+            status = text(std::to_string(state->set->files.size()) + " files") | dim;
+        }
+
+        Element body = text("");
+        if (state->pending) {
+            body = text("  the search starts once the logs are found") | dim | flex;
+        } else if (grep) {
+            body = std::make_shared<GrepRows>(*grep, &state->cursor) | flex;
+        } else {
+            body = text("  type a string, Enter to search every log of the set") | dim | flex;
+        }
+
+        return vbox({
+            hbox({
+                text("═══ GREP: ") | color(Color::Cyan),
+                text(state->set ? state->set->title : job_id) | bold | color(Color::Magenta),
+                text(" ═══") | color(Color::Cyan),
+            }) | center,
+            separator(),
+            hbox({text("  "), prompt, filler(), status, text("  ")}),
+            separator(),
+            body,
+            separator(),
+            hbox({
+                text("↑↓/PgUp/PgDn") | bold | color(Color::Yellow),
+                text(": select  ") | dim,
+                text("Enter") | bold | color(Color::Yellow),
+                text(": open log  ") | dim,
+                text("/") | bold | color(Color::Yellow),
+                text(": new search  ") | dim,
+                text("Esc") | bold | color(Color::Yellow),
+                text(": close") | dim,
+            }) | center,
+        }) | border | size(WIDTH, LESS_THAN, 150);
+    });
+
+    return CatchEvent(full_view, [=](Event e) {
+        load();
+        if (state->editing) {
+            if (e == Event::Return) {
+                state->editing = false;
+                if (state->input.empty()) return true;
+                if (state->set) search();
+                else state->pending = true;
+            } else if (e == Event::Escape) {
+                state->editing = false;
+                if (!state->grep && !state->pending) on_close();
+            } else if (e == Event::Backspace) {
+                if (!state->input.empty()) state->input.pop_back();
+            } else if (e.is_character()) {
+                state->input += e.character();
+            }
+            return true;
+        }
+
+        auto& c = state->cursor;
+        if (e.is_mouse()) {
+            if (e.mouse().button == Mouse::WheelDown) { select(c.selected + 3); return true; }
+            if (e.mouse().button == Mouse::WheelUp) { select(c.selected - std::min<size_t>(c.selected, 3)); return true; }
+            return false;
+        }
+
+        size_t page = (size_t)std::max(1, c.page - 2);
+        if (e == Event::ArrowDown) { select(c.selected + 1); return true; }
+        if (e == Event::ArrowUp) { select(c.selected - std::min<size_t>(c.selected, 1)); return true; }
+        if (e == Event::PageDown) { select(c.selected + page); return true; }
+        if (e == Event::PageUp) { select(c.selected - std::min(c.selected, page)); return true; }
+        if (e == Event::Home) { select(0); return true; }
+        if (e == Event::End) { select(SIZE_MAX); return true; }
+
+        if (e == Event::Character('/')) {
+            state->editing = true;
+            state->pending = false;
+            state->input.clear();
+            return true;
+        }
+
+        if (e == Event::Return) {
+            if (state->grep && c.anchored) on_open(state->set->targets[c.file], c.line, state->grep->needle());
+            return true;
+        }
+        if (e == Event::Escape) {
+            on_close();
+            return true;
+        }
+        return false;
+    });
+}
+
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <ftxui/component/component.hpp>
+#include <ftxui/dom/elements.hpp>
+#include "../api/slurmjobs.hpp"
+#include "../api/snapshot_cache.hpp"
+#include "direct_draw.hpp"
+#include "nodedetails.hpp"
+#include "viewport.hpp"
+
+namespace ui {
+using namespace ftxui;
+
+inline int percentOf(int64_t used, int64_t total) {
+    return total > 0 ? (int)(100 * used / total) : 0;
+}
+
+// Allocation fraction → colour: free, low, high, full
+inline Color heatColor(int64_t used, int64_t total) {
+    if (total <= 0 || used <= 0) return Color::GrayDark;
+    if (used * 10 >= total * 9) return Color::Red;
+    if (used * 2 >= total) return Color::Yellow;
+    return Color::Green;
+}
+
+// One character per node, for every node of the cluster, grouped by class.
+// Glyph height is the CPU allocation fraction, colour the GPU allocation
+// fraction (CPU fraction on CPU-only nodes). Down/drained nodes are an 'x'.
+class NodeHeatmap : public Node {
+public:
+    NodeHeatmap(std::shared_ptr<const api::NodeTable> table, LineViewport* view)
+        : table_(std::move(table)), view_(view) {
+        for (size_t c = 0; c < table_->classes(); ++c) {
+            stats_.push_back(api::aggregateClass(*table_, c));
+            names_.push_back(getApuDisplayName(table_->class_prefixes[c]));
+        }
+    }
+
+    void ComputeRequirement() override {
+        requirement_.min_x = 0;
+        requirement_.min_y = 0;
+        requirement_.flex_grow_x = 1;
+        requirement_.flex_grow_y = 1;
+        requirement_.flex_shrink_x = 1;
+        requirement_.flex_shrink_y = 1;
+    }
+
+    void SetBox(Box box) override {
+        Node::SetBox(box);
+        columns_ = std::max(1, box.x_max - box.x_min + 1);
+
+        // Per class: header line, ceil(nodes / columns) cell rows, blank line
+        class_y_.clear();
+        int y = 0;
+        for (size_t c = 0; c < table_->classes(); ++c) {
+            class_y_.push_back(y);
+            y += 2 + (stats_[c].nodes + columns_ - 1) / columns_;
+        }
+        view_->content = y;
+        view_->page = box.y_max - box.y_min + 1;
+        view_->scrollTo(view_->top);
+    }
+
+    void Render(Screen& screen) override {
+        DirectDraw draw(screen, box_);
+        if (draw.empty()) return;
+
+        static const char* levels[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+        const auto& t = *table_;
+        int origin = box_.y_min - view_->top;
+
+        for (size_t c = 0; c < t.classes(); ++c) {
+            const auto& s = stats_[c];
+            int top = origin + class_y_[c];
+            int rows = (s.nodes + columns_ - 1) / columns_;
+            if (top > draw.clip.y_max) break;
+            if (top + rows < draw.clip.y_min) continue;
+
+            int x = draw.text(box_.x_min, top, names_[c], Color::Magenta, true);
+            x = draw.text(x, top, "  " + std::to_string(s.nodes) + " nodes  CPU ");
+            x = draw.text(x, top, std::to_string(percentOf(s.cpu_alloc, s.cpu_total)) + "%",
+                          heatColor(s.cpu_alloc, s.cpu_total), true);
+            if (s.gpu_total > 0) {
+                x = draw.text(x, top, "  GPU ");
+                x = draw.text(x, top, std::to_string(percentOf(s.gpu_used, s.gpu_total)) + "%",
+                              heatColor(s.gpu_used, s.gpu_total), true);
+            }
+            x = draw.text(x, top, "  idle " + std::to_string(s.idle));
+            if (s.unavailable > 0)
+                draw.text(x, top, "  down/drain " + std::to_string(s.unavailable), Color::Red);
+
+            // Only visible cell rows are drawn
+            int first_row = std::max(0, draw.clip.y_min - (top + 1));
+            int last_row = std::min(rows - 1, draw.clip.y_max - (top + 1));
+            for (int row = first_row; row <= last_row; ++row) {
+                size_t begin = t.class_begin[c] + (size_t)row * columns_;
+                size_t end = std::min<size_t>(begin + columns_, t.class_begin[c + 1]);
+                for (size_t i = begin; i < end; ++i) {
+                    int cx = box_.x_min + (int)(i - begin);
+                    int cy = top + 1 + row;
+                    if (t.state[i] == api::NodeState::Down) {
+                        draw.put(cx, cy, "x", Color::Red);
+                    } else if (t.state[i] == api::NodeState::Drain) {
+                        draw.put(cx, cy, "x", Color::GrayDark);
+                    } else if (t.cpu_alloc[i] == 0 && t.gpu_used[i] == 0) {
+                        draw.put(cx, cy, "·", Color::GrayDark);
+                    } else {
+                        int level = t.cpu_total[i] > 0 ? (int)(7LL * t.cpu_alloc[i] / t.cpu_total[i]) : 7;
+                        Color fg = t.gpu_total[i] > 0 ? heatColor(t.gpu_used[i], t.gpu_total[i])
+                                                      : heatColor(t.cpu_alloc[i], t.cpu_total[i]);
+                        draw.put(cx, cy, levels[std::clamp(level, 0, 7)], fg);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    std::shared_ptr<const api::NodeTable> table_;
+    LineViewport* view_;
+    std::vector<api::NodeRangeStats> stats_;
+    std::vector<std::string> names_;
+    std::vector<int> class_y_;
+    int columns_ = 1;
+};
+
+using NodeTableCache = api::SnapshotCache<api::NodeTable>;
+
+// Shared by every heatmap view of the process
+inline NodeTableCache& nodeTables() {
+    static NodeTableCache cache(&api::slurm::getNodeTable, std::chrono::seconds(30));
+    return cache;
+}
+
+// Opens at once: the node table comes from scontrol run in the background
+// (when missing or old, and on r); "loading" until the first answer
+inline Component heatmapView(std::function<void()> on_close, std::function<void()> on_update = {}) {
+    auto& nodes = nodeTables();
+    auto table = std::make_shared<std::shared_ptr<const api::NodeTable>>();
+    auto view = std::make_shared<LineViewport>();
+    auto heatmap = std::make_shared<Element>();
+    auto total = std::make_shared<api::NodeRangeStats>();
+    nodes.refreshIfStale(on_update);
+
+    auto content = Renderer([=, &nodes] {
+        // The element is rebuilt once per snapshot and reused until the next one
+        auto latest = nodes.get();
+        if (!latest) {
+            return vbox({
+                text("══════════ CLUSTER NODES ══════════") | bold | center | color(Color::Cyan),
+                separator(),
+                text("Loading nodes (scontrol)...") | dim | center,
+            }) | border;
+        }
+        if (latest != *table) {
+            *table = latest;
+            *heatmap = std::make_shared<NodeHeatmap>(latest, view.get());
+            *total = api::aggregateNodes(*latest, 0, latest->size());
+        }
+        const auto& s = *total;
+        return vbox({
+            text("══════════ CLUSTER NODES ══════════") | bold | center | color(Color::Cyan),
+            separator(),
+            hbox({
+                text(std::to_string(s.nodes) + " nodes") | bold,
+                text("  CPU ") | dim,
+                text(std::to_string(s.cpu_alloc) + "/" + std::to_string(s.cpu_total) +
+                     " (" + std::to_string(percentOf(s.cpu_alloc, s.cpu_total)) + "%)") |
+                    color(heatColor(s.cpu_alloc, s.cpu_total)),
+                text("  GPU ") | dim,
+                text(std::to_string(s.gpu_used) + "/" + std::to_string(s.gpu_total) +
+                     " (" + std::to_string(percentOf(s.gpu_used, s.gpu_total)) + "%)") |
+                    color(heatColor(s.gpu_used, s.gpu_total)),
+                text("  Mem ") | dim,
+                text(std::to_string(percentOf(s.mem_alloc, s.mem_total)) + "%") |
+                    color(heatColor(s.mem_alloc, s.mem_total)),
+                text("  Idle ") | dim,
+                text(std::to_string(s.idle)) | color(Color::Green),
+                text("  Down/drain ") | dim,
+                text(std::to_string(s.unavailable)) | color(Color::Red),
+                filler(),
+                (nodes.refreshing() ? text("refreshing...  ") | color(Color::Green) : text("")),
+                text(std::to_string(view->percent()) + "%") | color(Color::Yellow),
+            }),
+            separator(),
+            *heatmap | flex,
+            separator(),
+            hbox({
+                text("Legend: ") | dim,
+                text("·") | color(Color::GrayDark), text(" free  ") | dim,
+                text("▁▄█") | color(Color::Green), text(" CPU alloc (height)  ") | dim,
+                text("█") | color(Color::Green), text("<50% ") | dim,
+                text("█") | color(Color::Yellow), text("<90% ") | dim,
+                text("█") | color(Color::Red), text(">=90% GPU alloc (colour)  ") | dim,
+                text("x") | color(Color::Red), text(" down  ") | dim,
+                text("x") | color(Color::GrayDark), text(" drain") | dim,
+            }) | center,
+            hbox({
+                text("↑↓/Wheel/PgUp/PgDn") | bold | color(Color::Yellow),
+                text(": scroll  ") | dim,
+                text("r") | bold | color(Color::Yellow),
+                text(": refresh  ") | dim,
+                text("Esc") | bold | color(Color::Yellow),
+                text(": close") | dim,
+            }) | center,
+        }) | border;
+    });
+
+    return CatchEvent(content, [=, &nodes](Event e) {
+        if (e.is_mouse()) {
+            if (e.mouse().button == Mouse::WheelDown) { view->scrollBy(3); return true; }
+            if (e.mouse().button == Mouse::WheelUp) { view->scrollBy(-3); return true; }
+            return false;
+        }
+        if (e == Event::ArrowDown) { view->scrollBy(1); return true; }
+        if (e == Event::ArrowUp) { view->scrollBy(-1); return true; }
+        if (e == Event::PageDown) { view->pageDown(); return true; }
+        if (e == Event::PageUp) { view->pageUp(); return true; }
+        if (e == Event::Home) { view->home(); return true; }
+        if (e == Event::End) { view->end(); return true; }
+
+        if (e == Event::Character('r') || e == Event::Character('R')) {
+            nodes.refreshAsync(on_update);
+            return true;
+        }
+        if (e == Event::Escape || e == Event::Return ||
+            e == Event::Character('q') || e == Event::Character('Q')) {
+            on_close();
+            return true;
+        }
+        return false;
+    });
+}
+
+}
@@ -2,96 +2,21 @@
 
 #include <ftxui/component/component.hpp>
 #include <ftxui/dom/elements.hpp>
-#include <sstream>
 #include <algorithm>
-#include "../api/slurmjobs.hpp"
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include "../api/history_store.hpp"
+#include "../api/snapshot_cache.hpp"
+#include "direct_draw.hpp"
+#include "viewport.hpp"
 
 namespace ui {
 using namespace ftxui;
 
-struct HistoryJob {
-    std::string id;
-    std::string name;
-    std::string state;
-    std::string start;
-    std::string end;
-    std::string elapsed;
-    std::string exit_code;
-    std::string max_rss;      // Peak memory usage
-    std::string cpu_time;     // Total CPU time
-    std::string ncpus;        // Number of CPUs
-    std::string nnodes;       // Number of nodes
-    std::string partition;
-    std::string account;
-};
-
-inline std::vector<HistoryJob> getJobHistory(const std::string& filter = "") {
-    std::vector<HistoryJob> history;
-
-    const char* user = std::getenv("USER");
-    if (!user) user = "unknown";
-
-    // Use sacct to get job history with more details
-    std::string cmd = "sacct -u " + std::string(user) +
-                      " --starttime=now-7days"
-                      " --format=JobID,JobName%30,State,Start,End,Elapsed,ExitCode,MaxRSS,CPUTime,NCPUs,NNodes,Partition,Account"
-                      " --noheader -P 2>/dev/null";
-
-    // Add state filter if specified
-    if (!filter.empty()) {
-        cmd = "sacct -u " + std::string(user) +
-              " --starttime=now-7days -s " + filter +
-              " --format=JobID,JobName%30,State,Start,End,Elapsed,ExitCode,MaxRSS,CPUTime,NCPUs,NNodes,Partition,Account"
-              " --noheader -P 2>/dev/null";
-    }
-
-    std::array<char, 512> buffer;
-    std::unique_ptr<FILE, int(*)(FILE*)> pipe(
-        popen(cmd.c_str(), "r"),
-        static_cast<int(*)(FILE*)>(pclose)
-    );
-
-    if (!pipe) return history;
-
-    while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-        std::string line = buffer.data();
-        if (line.empty() || line[0] == '\n') continue;
-
-        if (!line.empty() && line.back() == '\n') line.pop_back();
-
-        std::istringstream iss(line);
-        std::string field;
-        std::vector<std::string> fields;
-
-        while (std::getline(iss, field, '|')) {
-            fields.push_back(field);
-        }
-
-        if (fields.size() >= 7) {
-            // Skip step entries (those with . in JobID like 12345.batch)
-            if (fields[0].find('.') != std::string::npos) continue;
-
-            HistoryJob job;
-            job.id = fields[0];
-            job.name = fields[1];
-            job.state = fields[2];
-            job.start = fields[3];
-            job.end = fields[4];
-            job.elapsed = fields[5];
-            job.exit_code = fields[6];
-            if (fields.size() > 7) job.max_rss = fields[7];
-            if (fields.size() > 8) job.cpu_time = fields[8];
-            if (fields.size() > 9) job.ncpus = fields[9];
-            if (fields.size() > 10) job.nnodes = fields[10];
-            if (fields.size() > 11) job.partition = fields[11];
-            if (fields.size() > 12) job.account = fields[12];
-            history.push_back(job);
-        }
-    }
-
-    std::reverse(history.begin(), history.end());
-    return history;
-}
+using api::HistoryJob;
 
 inline Color getStateColor(const std::string& state) {
     if (state.find("COMPLETED") != std::string::npos) return Color::Green;
@@ -104,108 +29,302 @@ inline Color getStateColor(const std::string& state) {
     return Color::White;
 }
 
-inline std::string formatMemory(const std::string& mem) {
-    if (mem.empty()) return "-";
-    // Already formatted like "1234K" or "512M"
-    return mem;
+// Table cells; "-" when unknown
+inline std::string formatBytes(int64_t bytes) {
+    if (bytes < 0) return "-";
+    static const char* units[] = {"B", "K", "M", "G", "T"};
+    double value = (double)bytes;
+    int unit = 0;
+    while (value >= 1024 && unit < 4) {
+        value /= 1024;
+        unit++;
+    }
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), value < 10 && unit > 0 ? "%.1f%s" : "%.0f%s", value, units[unit]);
+    return buf;
 }
 
-inline Component historyView(std::shared_ptr<float> scroll_y, std::shared_ptr<int> filter_mode,
-                             std::function<void()> on_close) {
-    auto history = std::make_shared<std::vector<HistoryJob>>();
-    auto selected_job = std::make_shared<int>(-1);  // -1 = no selection, show list
+inline std::string formatDuration(int64_t seconds) {
+    if (seconds < 0) return "-";
+    char buf[32];
+    int64_t days = seconds / 86400;
+    int h = (int)(seconds / 3600 % 24), m = (int)(seconds / 60 % 60), sec = (int)(seconds % 60);
+    if (days > 0) std::snprintf(buf, sizeof(buf), "%lld-%02d:%02d:%02d", (long long)days, h, m, sec);
+    else std::snprintf(buf, sizeof(buf), "%02d:%02d:%02d", h, m, sec);
+    return buf;
+}
 
-    // Filter options
+inline std::string formatDate(int64_t epoch) {
+    if (epoch <= 0) return "-";
+    std::time_t t = (std::time_t)epoch;
+    std::tm tm{};
+    localtime_r(&t, &tm);
+    char buf[16];
+    std::strftime(buf, sizeof(buf), "%m-%d %H:%M", &tm);
+    return buf;
+}
+
+// Windows of the history view (w), in days
+inline const std::vector<int>& historyWindows() {
+    static const std::vector<int> windows = {api::HistoryStore::DEFAULT_DAYS, 30, 90, 365};
+    return windows;
+}
+
+// State tabs of the history view: state prefix ("CANCELLED by 123") and label
+inline const std::vector<std::pair<std::string, std::string>>& historyFilters() {
     static const std::vector<std::pair<std::string, std::string>> filters = {
         {"", "ALL"},
-        {"r", "RUNNING"},
-        {"pd", "PENDING"},
-        {"cd", "COMPLETED"},
-        {"f", "FAILED"},
-        {"ca", "CANCELLED"},
-        {"to", "TIMEOUT"},
+        {"RUNNING", "RUNNING"},
+        {"PENDING", "PENDING"},
+        {"COMPLETED", "COMPLETED"},
+        {"FAILED", "FAILED"},
+        {"CANCELLED", "CANCELLED"},
+        {"TIMEOUT", "TIMEOUT"},
     };
+    return filters;
+}
+
+// The rows of every state tab within a window of one store table, listed
+// once, so that switching tabs, counting them and filtering by text never
+// run sacct. Built off the UI thread each time the store publishes; the
+// table itself is shared with the store, not copied.
+struct HistoryIndex {
+    std::shared_ptr<const api::HistoryTable> table = std::make_shared<api::HistoryTable>();
+    std::vector<std::vector<uint32_t>> by_filter;  // Rows of each tab
+    uint64_t version = UINT64_MAX;                 // Store version of the table
+    int days = 0;
+
+    static std::string lower(std::string s) {
+        for (char& c : s) c = (char)std::tolower((unsigned char)c);
+        return s;
+    }
+
+    HistoryIndex() : by_filter(historyFilters().size()) {}
+
+    // Rows still active or ended within the last `days`
+    HistoryIndex(std::shared_ptr<const api::HistoryTable> t, uint64_t v, int d)
+        : table(std::move(t)), by_filter(historyFilters().size()), version(v), days(d) {
+        const auto& filters = historyFilters();
+        std::vector<api::JobState> states;
+        for (const auto& f : filters) states.push_back(api::history::parseState(f.first));
+
+        int64_t since = (int64_t)std::time(nullptr) - (int64_t)days * 86400;
+        const auto& t_ = *table;
+        for (uint32_t row = 0; row < t_.size(); ++row) {
+            if (t_.end[row] != 0 && t_.end[row] < since) continue;
+            by_filter[0].push_back(row);
+            for (size_t f = 1; f < filters.size(); ++f)
+                if (t_.state[row] == states[f]) by_filter[f].push_back(row);
+        }
+    }
 
-    auto reload_history = [=]() {
-        *history = getJobHistory(filters[*filter_mode].first);
+    // Rows of a tab whose name or partition contains `query` (lowercase), as a mask
+    std::vector<uint8_t> mask(size_t filter, const std::string& query) const {
+        std::vector<uint8_t> out(table->size(), 0);
+        const auto& search = table->search;
+        for (uint32_t row : by_filter[filter])
+            if (query.empty() || search[row].find(query) != std::string::npos) out[row] = 1;
+        return out;
+    }
+};
+
+// Columns of the history table: what they sort by, header and width
+struct HistoryColumn {
+    api::HistoryTable::Column column;
+    const char* title;
+    int width;
+};
+
+inline const std::vector<HistoryColumn>& historyColumns() {
+    using T = api::HistoryTable;
+    static const std::vector<HistoryColumn> columns = {
+        {T::Id, "ID", 12},          {T::Name, "NAME", 20},   {T::State, "STATE", 12}, {T::Start, "START", 12},
+        {T::Elapsed, "ELAPSED", 12}, {T::Cpus, "CPU", 5},     {T::Memory, "MEM", 8},   {T::Exit, "EXIT", 6},
     };
+    return columns;
+}
 
-    reload_history();
+// Rows of the history drawn straight into the screen; only the rows inside
+// the viewport are formatted, whatever the length of the history
+class HistoryRows : public Node {
+public:
+    static constexpr int MAX_ROWS = 19;
+
+    HistoryRows(const api::HistoryTable& table, const std::vector<uint32_t>& rows, LineViewport* view)
+        : table_(table), rows_(rows), view_(view) {}
+
+    void ComputeRequirement() override {
+        int width = 0;
+        for (const auto& c : historyColumns()) width += c.width;
+        requirement_.min_x = width;
+        requirement_.min_y = std::min((int)rows_.size(), MAX_ROWS);
+        requirement_.flex_grow_x = 1;
+        requirement_.flex_grow_y = 1;
+        requirement_.flex_shrink_x = 1;
+        requirement_.flex_shrink_y = 1;
+    }
 
-    auto list_content = Renderer([=] {
-        std::vector<Element> rows;
+    void SetBox(Box box) override {
+        Node::SetBox(box);
+        view_->content = (int)rows_.size();
+        view_->page = box.y_max - box.y_min + 1;
+        view_->scrollTo(view_->top);
+    }
 
-        // Header
-        rows.push_back(
-            hbox({
-                text("ID") | bold | size(WIDTH, EQUAL, 10),
-                text("NAME") | bold | size(WIDTH, EQUAL, 20),
-                text("STATE") | bold | size(WIDTH, EQUAL, 12),
-                text("ELAPSED") | bold | size(WIDTH, EQUAL, 10),
-                text("CPU") | bold | size(WIDTH, EQUAL, 6),
-                text("MEM") | bold | size(WIDTH, EQUAL, 10),
-                text("EXIT") | bold | size(WIDTH, EQUAL, 6),
-            })
-        );
-        rows.push_back(separator());
-
-        for (const auto& job : *history) {
-            std::string name = job.name;
-            if (name.length() > 18) name = name.substr(0, 15) + "...";
-
-            rows.push_back(hbox({
-                text(job.id) | size(WIDTH, EQUAL, 10),
-                text(name) | size(WIDTH, EQUAL, 20),
-                text(job.state) | color(getStateColor(job.state)) | size(WIDTH, EQUAL, 12),
-                text(job.elapsed) | color(Color::Cyan) | size(WIDTH, EQUAL, 10),
-                text(job.ncpus.empty() ? "-" : job.ncpus) | size(WIDTH, EQUAL, 6),
-                text(formatMemory(job.max_rss)) | color(Color::Yellow) | size(WIDTH, EQUAL, 10),
-                text(job.exit_code) | (job.exit_code == "0:0" ? color(Color::Green) : color(Color::Red)) | size(WIDTH, EQUAL, 6),
-            }));
+    void Render(Screen& screen) override {
+        DirectDraw draw(screen, box_);
+        if (draw.empty()) return;
+        const auto& columns = historyColumns();
+        int end = std::min((int)rows_.size(), view_->top + view_->page);
+        for (int i = view_->top; i < end; ++i) {
+            uint32_t row = rows_[i];
+            int y = box_.y_min + i - view_->top;
+            int x = box_.x_min;
+            for (const auto& c : columns) {
+                Color fg = Color::Default;
+                std::string cell = this->cell(c.column, row, fg);
+                // Long names keep their start
+                if ((int)cell.size() > c.width - 2) cell = cell.substr(0, c.width - 5) + "...";
+                draw.text(x, y, cell, fg);
+                x += c.width;
+            }
         }
+    }
 
-        return vbox(rows);
-    });
+private:
+    std::string cell(api::HistoryTable::Column column, uint32_t row, Color& fg) const {
+        using T = api::HistoryTable;
+        const auto& t = table_;
+        switch (column) {
+            case T::Id: return t.id[row];
+            case T::Name: return t.name[row];
+            case T::State: fg = getStateColor(t.state_text[row]); return t.state_text[row];
+            case T::Start: return formatDate(t.start[row]);
+            case T::Elapsed: fg = Color::Cyan; return formatDuration(t.elapsed[row]);
+            case T::Cpus: return t.ncpus[row] < 0 ? "-" : std::to_string(t.ncpus[row]);
+            case T::Memory: fg = Color::Yellow; return formatBytes(t.max_rss[row]);
+            case T::Exit: fg = t.exit_code[row] == 0 ? Color::Green : Color::Red; return t.exit_text[row];
+            default: return "";
+        }
+    }
 
-    auto scrollable = Renderer(list_content, [=] {
-        return list_content->Render()
-               | focusPositionRelative(0.f, *scroll_y)
-               | frame
-               | size(HEIGHT, LESS_THAN, 20);
-    });
+    const api::HistoryTable& table_;
+    const std::vector<uint32_t>& rows_;
+    LineViewport* view_;
+};
 
-    auto full_view = Renderer(scrollable, [=] {
-        int total_jobs = history->size();
-        int scroll_percent = (int)(*scroll_y * 100);
+// Served from the local history store; a sync runs in the background when
+// it is stale, when a wider window is picked (or on r), and on_update is
+// called as its jobs stream in. The tab index of each published table is
+// built on a worker and swapped in by the renderer.
+inline Component historyView(std::shared_ptr<LineViewport> view, std::shared_ptr<int> filter_mode,
+                             std::function<void()> on_close, std::function<void()> on_update = {}) {
+    auto& store = api::HistoryStore::instance();
+    const auto& filters = historyFilters();
+    const auto& columns = historyColumns();
+    auto window = std::make_shared<size_t>(0);  // Into historyWindows()
+    auto window_days = std::make_shared<std::atomic<int>>(historyWindows()[0]);
+    auto indexes = std::make_shared<api::SnapshotCache<HistoryIndex>>(
+        [&store, window_days] {
+            uint64_t version = store.version();  // Read first: a table published meanwhile is indexed again
+            return HistoryIndex(store.table(), version, *window_days);
+        },
+        std::chrono::seconds(0));
+    auto index = std::make_shared<std::shared_ptr<const HistoryIndex>>(std::make_shared<HistoryIndex>());
+    auto shown = std::make_shared<std::vector<uint32_t>>();  // Rows shown: filtered, then sorted
+
+    // Name/partition filter (/), applied as it is typed
+    struct TextFilter {
+        bool editing = false;
+        std::string input;
+    };
+    auto text_filter = std::make_shared<TextFilter>();
+
+    // Sort column (s) and direction (S); newest first by default
+    struct Sort {
+        size_t column = 0;
+        bool descending = true;
+    };
+    auto sort = std::make_shared<Sort>();
+
+    auto apply_filter = [=] {
+        const auto& i = **index;
+        auto mask = i.mask((size_t)*filter_mode, HistoryIndex::lower(text_filter->input));
+        *shown = i.table->sorted(mask, columns[sort->column].column, sort->descending);
+    };
+
+    indexes->refreshAsync(on_update);
+    store.syncIfStale(*window_days, on_update);
+
+    auto full_view = Renderer([=, &store] {
+        // A new index is swapped in; one is asked for when the store or the window changed
+        auto latest = indexes->get();
+        if (latest && latest != *index) {
+            *index = latest;
+            apply_filter();
+        }
+        if (!indexes->refreshing() && latest && (latest->version != store.version() || latest->days != *window_days))
+            indexes->refreshAsync(on_update);
+        int total_jobs = shown->size();
+        int days = historyWindows()[*window];
 
         // Filter tabs
         std::vector<Element> filter_tabs;
         for (size_t i = 0; i < filters.size(); i++) {
+            std::string label = filters[i].second + " " + std::to_string((*index)->by_filter[i].size());
             if ((int)i == *filter_mode) {
-                filter_tabs.push_back(text("[" + filters[i].second + "]") | bold | color(Color::Cyan));
+                filter_tabs.push_back(text("[" + label + "]") | bold | color(Color::Cyan));
+            } else {
+                filter_tabs.push_back(text(" " + label + " ") | dim);
+            }
+        }
+
+        // Header, with the sort column marked
+        Elements header;
+        for (size_t i = 0; i < columns.size(); ++i) {
+            std::string title = columns[i].title;
+            if (i == sort->column) {
+                header.push_back(text(title + (sort->descending ? " ▼" : " ▲")) | bold | color(Color::Cyan) |
+                                 size(WIDTH, EQUAL, columns[i].width));
             } else {
-                filter_tabs.push_back(text(" " + filters[i].second + " ") | dim);
+                header.push_back(text(title) | bold | size(WIDTH, EQUAL, columns[i].width));
             }
         }
 
         return vbox({
-            text("═══════════ JOB HISTORY (last 7 days) ═══════════") | bold | center | color(Color::Cyan),
+            text("═══════════ JOB HISTORY (last " + std::to_string(days) + " days) ═══════════") | bold | center |
+                color(Color::Cyan),
             separator(),
             hbox(filter_tabs) | center,
             separator(),
             hbox({
                 text(std::to_string(total_jobs) + " jobs") | dim,
+                (text_filter->editing ? text("  /" + text_filter->input + "█") | bold | color(Color::Yellow)
+                 : !text_filter->input.empty() ? text("  name/partition: " + text_filter->input) | color(Color::Yellow)
+                                               : text("")),
                 filler(),
-                text(std::to_string(scroll_percent) + "%") | color(Color::Yellow),
+                (store.syncing() ? text("syncing with sacct " + std::to_string(store.slicesDone()) + "/" +
+                                        std::to_string(store.slicesTotal()) + "...  ") |
+                                       color(Color::Green)
+                                 : text("")),
+                text(std::to_string(view->percent()) + "%") | color(Color::Yellow),
             }),
             separator(),
-            scrollable->Render() | flex,
+            hbox(header),
+            separator(),
+            std::make_shared<HistoryRows>(*(*index)->table, *shown, view.get()) | flex,
             separator(),
             hbox({
                 text("←→") | bold | color(Color::Yellow),
                 text(": filter  ") | dim,
                 text("↑↓") | bold | color(Color::Yellow),
                 text(": scroll  ") | dim,
+                text("s/S") | bold | color(Color::Yellow),
+                text(": sort  ") | dim,
+                text("/") | bold | color(Color::Yellow),
+                text(": name/partition  ") | dim,
+                text("w") | bold | color(Color::Yellow),
+                text(": window  ") | dim,
                 text("r") | bold | color(Color::Yellow),
                 text(": refresh  ") | dim,
                 text("Esc") | bold | color(Color::Yellow),
@@ -214,48 +333,91 @@ inline Component historyView(std::shared_ptr<float> scroll_y, std::shared_ptr<in
         }) | border | size(WIDTH, LESS_THAN, 95);
     });
 
-    return CatchEvent(full_view, [=](Event e) {
-        constexpr float scroll_step = 0.05f;
+    return CatchEvent(full_view, [=, &store](Event e) {
+        // Typing the text filter: Enter keeps it, Escape clears it
+        if (text_filter->editing) {
+            if (e == Event::Return) {
+                text_filter->editing = false;
+            } else if (e == Event::Escape) {
+                text_filter->editing = false;
+                text_filter->input.clear();
+            } else if (e == Event::Backspace) {
+                if (!text_filter->input.empty()) text_filter->input.pop_back();
+            } else if (e.is_character()) {
+                text_filter->input += e.character();
+            } else {
+                return false;
+            }
+            view->home();
+            apply_filter();
+            return true;
+        }
+        if (e == Event::Character('/')) {
+            text_filter->editing = true;
+            return true;
+        }
 
         // Mouse wheel scrolling
         if (e.is_mouse()) {
             if (e.mouse().button == Mouse::WheelDown) {
-                *scroll_y = std::min(*scroll_y + scroll_step, 1.f);
+                view->scrollBy(3);
                 return true;
             }
             if (e.mouse().button == Mouse::WheelUp) {
-                *scroll_y = std::max(*scroll_y - scroll_step, 0.f);
+                view->scrollBy(-3);
                 return true;
             }
         }
 
-        // Arrow keys for scrolling
-        if (e == Event::ArrowDown) {
-            *scroll_y = std::min(*scroll_y + scroll_step, 1.f);
-            return true;
-        }
-        if (e == Event::ArrowUp) {
-            *scroll_y = std::max(*scroll_y - scroll_step, 0.f);
-            return true;
-        }
+        if (e == Event::ArrowDown) { view->scrollBy(1); return true; }
+        if (e == Event::ArrowUp) { view->scrollBy(-1); return true; }
+        if (e == Event::PageDown) { view->pageDown(); return true; }
+        if (e == Event::PageUp) { view->pageUp(); return true; }
+        if (e == Event::Home) { view->home(); return true; }
+        if (e == Event::End) { view->end(); return true; }
 
         // Arrow keys for filter cycling
         if (e == Event::ArrowRight) {
             *filter_mode = (*filter_mode + 1) % filters.size();
-            *scroll_y = 0.f;
-            reload_history();
+            view->home();
+            apply_filter();
             return true;
         }
         if (e == Event::ArrowLeft) {
             *filter_mode = (*filter_mode - 1 + filters.size()) % filters.size();
-            *scroll_y = 0.f;
-            reload_history();
+            view->home();
+            apply_filter();
+            return true;
+        }
+
+        // Sort: s moves to the next column (largest first, names A to Z), S reverses
+        if (e == Event::Character('s')) {
+            sort->column = (sort->column + 1) % columns.size();
+            sort->descending = columns[sort->column].column != api::HistoryTable::Name;
+            view->home();
+            apply_filter();
+            return true;
+        }
+        if (e == Event::Character('S')) {
+            sort->descending = !sort->descending;
+            view->home();
+            apply_filter();
+            return true;
+        }
+
+        // Window: 7, 30, 90, 365 days; a wider one is fetched in the background
+        if (e == Event::Character('w') || e == Event::Character('W')) {
+            *window = (*window + 1) % historyWindows().size();
+            *window_days = historyWindows()[*window];
+            view->home();
+            indexes->refreshAsync(on_update);
+            store.syncIfStale(*window_days, on_update);
             return true;
         }
 
         // Refresh
         if (e == Event::Character('r') || e == Event::Character('R')) {
-            reload_history();
+            store.syncAsync(historyWindows()[*window], on_update);
             return true;
         }
 
@@ -270,9 +432,10 @@ inline Component historyView(std::shared_ptr<float> scroll_y, std::shared_ptr<in
 }
 
 // Overload for backward compatibility
-inline Component historyView(std::shared_ptr<float> scroll_y, std::function<void()> on_close) {
+inline Component historyView(std::shared_ptr<LineViewport> view, std::function<void()> on_close,
+                             std::function<void()> on_update = {}) {
     auto filter_mode = std::make_shared<int>(0);
-    return historyView(scroll_y, filter_mode, on_close);
+    return historyView(view, filter_mode, on_close, on_update);
 }
 
 }
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <ftxui/component/component.hpp>
+#include <ftxui/component/event.hpp>
+#include <ftxui/dom/node.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../api/job_table.hpp"
+#include "direct_draw.hpp"
+#include "viewport.hpp"
+
+namespace ui {
+using namespace ftxui;
+
+// Sidebar rows: the jobs of the table matching the filter, in squeue order
+// or sorted, kept as row ids into the table so a refresh only re-lists ids
+// (the table patched the jobs themselves). The selection is a job id: it
+// stays on its job when jobs above it come and go or the list is re-sorted.
+struct JobListState : LineViewport {
+    enum Sort { Queue, Id, Name, Entry, SORTS };
+
+    std::shared_ptr<const api::JobTable> table;
+    api::JobFilter filter;
+    Sort sort = Queue;
+    bool show_user = false;  // --all: "user: name (id)"
+
+    std::vector<uint32_t> rows;
+    std::string selected_id;
+    size_t selected = 0;
+    Box box;  // Where the rows were drawn, for the mouse
+
+    JobListState(std::shared_ptr<const api::JobTable> t, bool users) : table(std::move(t)), show_user(users) {}
+
+    // Re-lists the rows after a table update, a new filter or sort. Returns
+    // true when the selection moved to another job (its job is gone).
+    bool refresh() {
+        rows = table->select(filter);
+        sortRows();
+        content = (int)rows.size();
+        uint32_t row = selected_id.empty() ? api::JobTable::NONE : table->find(selected_id);
+        if (row != api::JobTable::NONE) {
+            auto it = std::find(rows.begin(), rows.end(), row);
+            if (it != rows.end()) {
+                selected = (size_t)(it - rows.begin());
+                return false;
+            }
+        }
+        // Gone or filtered out: the job that took its place
+        std::string before = selected_id;
+        selected = rows.empty() ? 0 : std::min(selected, rows.size() - 1);
+        selected_id = rows.empty() ? "" : table->job(rows[selected]).id;
+        return selected_id != before;
+    }
+
+    const api::Job* selectedJob() const {
+        return rows.empty() ? nullptr : &table->job(rows[selected]);
+    }
+
+    // Returns true when another job got selected
+    bool select(long index) {
+        if (rows.empty()) return false;
+        selected = (size_t)std::clamp<long>(index, 0, (long)rows.size() - 1);
+        std::string id = table->job(rows[selected]).id;
+        if (id == selected_id) return false;
+        selected_id = std::move(id);
+        return true;
+    }
+
+    static const char* sortName(Sort sort) {
+        static const char* names[] = {"Default", "ID", "Name", "Entry"};
+        return names[sort];
+    }
+
+private:
+    // "1234", "1234_5" or "1234_[6-9]" as one number: base id, then task
+    static uint64_t idKey(const std::string& id) {
+        char* end;
+        uint64_t base = std::strtoull(id.c_str(), &end, 10);
+        uint64_t task = *end == '_' && std::isdigit((unsigned char)end[1]) ? std::strtoull(end + 1, nullptr, 10) + 1 : 0;
+        return base << 24 | std::min<uint64_t>(task, (1 << 24) - 1);
+    }
+
+    void sortRows() {
+        const auto& t = *table;
+        switch (sort) {
+            case Id: {
+                std::vector<std::pair<uint64_t, uint32_t>> keyed;
+                keyed.reserve(rows.size());
+                for (uint32_t row : rows) keyed.emplace_back(idKey(t.job(row).id), row);
+                std::sort(keyed.begin(), keyed.end());
+                for (size_t i = 0; i < keyed.size(); ++i) rows[i] = keyed[i].second;
+                break;
+            }
+            case Name:
+                std::stable_sort(rows.begin(), rows.end(),
+                                 [&](uint32_t a, uint32_t b) { return t.job(a).name < t.job(b).name; });
+                break;
+            case Entry:
+                std::stable_sort(rows.begin(), rows.end(),
+                                 [&](uint32_t a, uint32_t b) { return t.job(a).entry_name < t.job(b).entry_name; });
+                break;
+            default: break;
+        }
+    }
+};
+
+// The rows on screen drawn straight from the table; the label of a job is
+// only formatted when its row is visible
+class JobRows : public Node {
+public:
+    explicit JobRows(JobListState* state) : state_(state) {}
+
+    void ComputeRequirement() override {
+        requirement_.min_x = 0;
+        requirement_.min_y = 1;
+        requirement_.flex_grow_x = 1;
+        requirement_.flex_grow_y = 1;
+        requirement_.flex_shrink_x = 1;
+        requirement_.flex_shrink_y = 1;
+    }
+
+    // Scrolls just enough to keep the selection on screen
+    void SetBox(Box box) override {
+        Node::SetBox(box);
+        auto& s = *state_;
+        s.box = box;
+        s.content = (int)s.rows.size();
+        s.page = box.y_max - box.y_min + 1;
+        int selected = (int)s.selected;
+        if (selected < s.top) s.top = selected;
+        if (selected >= s.top + s.page) s.top = selected - s.page + 1;
+        s.scrollTo(s.top);
+    }
+
+    void Render(Screen& screen) override {
+        DirectDraw draw(screen, box_);
+        if (draw.empty()) return;
+        const auto& s = *state_;
+        int width = box_.x_max - box_.x_min + 1;
+        int end = std::min((int)s.rows.size(), s.top + s.page);
+        for (int i = s.top; i < end; ++i) {
+            const api::Job& job = s.table->job(s.rows[i]);
+            int y = box_.y_min + i - s.top;
+            bool selected = i == (int)s.selected;
+            draw.put(box_.x_min, y, selected ? ">" : " ", Color::Default, selected);
+            draw.line(box_.x_min + 1, y, s.show_user ? job.user + ": " + job.entry_name : job.entry_name, 0);
+            if (selected) draw.invert(box_.x_min, y, width);
+        }
+    }
+
+private:
+    JobListState* state_;
+};
+
+// Job list of the sidebar; on_change runs when another job is selected
+inline Component jobList(std::shared_ptr<JobListState> state, std::function<void()> on_change) {
+    auto rows = Renderer([=](bool) { return std::make_shared<JobRows>(state.get()); });
+
+    return CatchEvent(rows, [=](Event e) {
+        auto move = [&](long index) {
+            if (state->select(index)) on_change();
+            return true;
+        };
+        long selected = (long)state->selected;
+
+        if (e.is_mouse()) {
+            const auto& m = e.mouse();
+            if (!state->box.Contain(m.x, m.y)) return false;
+            if (m.button == Mouse::WheelDown) return move(selected + 1);
+            if (m.button == Mouse::WheelUp) return move(selected - 1);
+            long row = state->top + (m.y - state->box.y_min);
+            if (m.button == Mouse::Left && m.motion == Mouse::Pressed && row < (long)state->rows.size())
+                return move(row);
+            return false;
+        }
+        if (e == Event::ArrowDown) return move(selected + 1);
+        if (e == Event::ArrowUp) return move(selected - 1);
+        if (e == Event::Home) return move(0);
+        if (e == Event::End) return move((long)state->rows.size() - 1);
+        return false;
+    });
+}
+
+}
@@ -2,87 +2,376 @@
 
 #include <ftxui/component/component.hpp>
 #include <ftxui/dom/elements.hpp>
-#include <fstream>
-#include <sstream>
 #include <algorithm>
+#include <cctype>
+#include <cstdio>
 #include "../api/slurmjobs.hpp"
+#include "../api/log_reader.hpp"
+#include "../api/log_follower.hpp"
+#include "../api/line_index.hpp"
+#include "../api/text_search.hpp"
+#include "direct_draw.hpp"
+#include "viewport.hpp"
 
 namespace ui {
 using namespace ftxui;
 
-inline std::vector<std::string> readLogFileLines(const std::string& path, int max_lines = 500) {
-    std::vector<std::string> lines;
-
+// Last max_lines lines of a log, read backwards from EOF
+inline api::LogTail readLogTail(const std::string& path, int max_lines = 500) {
     if (path.empty() || path == "(null)") {
-        lines.push_back("[File not specified]");
-        return lines;
+        return api::LogTail::message("[File not specified]");
+    }
+
+    auto tail = api::LogTail::read(path, max_lines);
+    if (!tail.error().empty()) {
+        return api::LogTail::message("[Cannot open: " + path + "]");
     }
+    if (tail.empty()) {
+        return api::LogTail::message("[Empty file]");
+    }
+    return tail;
+}
+
+// Placeholder of a compressed log until its first lines are decompressed
+inline api::LogTail compressedNotice(api::Compression compression) {
+    std::string name = api::compressionName(compression);
+    if (!api::canDecompress(compression))
+        return api::LogTail::message("[" + name + " log: rsv was built without " + name + " support]");
+    return api::LogTail::message("[" + name + " log: decompressing...]");
+}
+
+// Lines kept per stream in follow mode
+constexpr size_t FOLLOW_LINES = 5000;
+
+inline std::unique_ptr<api::LogFollower> followLog(const std::string& path, std::function<void()> on_update) {
+    if (path.empty() || path == "(null)") return nullptr;
+    if (api::detectCompression(path) != api::Compression::None) return nullptr;  // A finished job's log
+    auto follower = std::make_unique<api::LogFollower>(path, FOLLOW_LINES, std::move(on_update));
+    if (!follower->start()) return nullptr;
+    return follower;
+}
+
+// Scroll state of the log view: a line offset plus a column offset
+struct LogViewport : LineViewport {
+    int left = 0;              // First visible column (horizontal scroll)
+    bool follow_tail = false;  // Stay on the last page as lines are appended
+};
+
+// Log lines drawn straight into the screen. Only the rows inside the viewport
+// are visited, so the cost of a frame does not depend on the log length.
+// Line numbers are coloured by class (error/warning); the right-most column
+// is a heatmap of the whole source, one bucket of lines per row.
+class LogLines : public Node {
+public:
+    static constexpr int MAX_ROWS = 24;
+    static constexpr int MAX_COLUMNS = 120;
 
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        lines.push_back("[Cannot open: " + path + "]");
-        return lines;
+    LogLines(const api::LineSource& source, LogViewport* view, std::string highlight = {})
+        : source_(source), view_(view), highlight_(std::move(highlight)) {}
+
+    void ComputeRequirement() override {
+        count_ = source_.lineCount();
+        requirement_.min_x = 6 + MAX_COLUMNS + 1;
+        requirement_.min_y = (int)std::min<size_t>(count_, MAX_ROWS);
+        requirement_.flex_grow_x = 1;
+        requirement_.flex_grow_y = 1;
+        requirement_.flex_shrink_x = 1;
+        requirement_.flex_shrink_y = 1;
     }
 
-    std::string line;
-    while (std::getline(file, line)) {
-        lines.push_back(line);
+    void SetBox(Box box) override {
+        Node::SetBox(box);
+        view_->content = (int)count_;
+        view_->page = box.y_max - box.y_min + 1;
+        if (view_->follow_tail) view_->end();
+        else view_->scrollTo(view_->top);
+
+        // Wide enough for the largest line number on screen
+        gutter_ = std::max(5, (int)std::to_string((size_t)view_->top + view_->page).size()) + 1;
     }
 
-    if (lines.empty()) {
-        lines.push_back("[Empty file]");
-        return lines;
+    void Render(Screen& screen) override {
+        Box text_box = box_;
+        text_box.x_max--;  // Heatmap column
+        DirectDraw draw(screen, text_box);
+        if (draw.empty()) return;
+
+        std::vector<uint32_t> row_tags(view_->page);
+        for (int r = 0; r < view_->page; ++r)
+            row_tags[r] = source_.rangeTags((size_t)view_->top + r, (size_t)view_->top + r + 1);
+
+        char number[24];
+        source_.visit((size_t)view_->top, (size_t)view_->page, [&](size_t i, std::string_view line) {
+            int row = (int)i - view_->top;
+            int y = box_.y_min + row;
+            std::snprintf(number, sizeof(number), "%*zu ", gutter_ - 1, i + 1);
+            draw.text(box_.x_min, y, number, tagColor(row_tags[row], Color::GrayDark), row_tags[row] != 0);
+            if (draw.line(box_.x_min + gutter_, y, line, (size_t)view_->left))
+                draw.put(text_box.x_max, y, "›", Color::Yellow);
+            if (!highlight_.empty()) highlightMatches(draw, y, line);
+        });
+
+        drawHeatmap(screen);
     }
 
-    // Keep only last max_lines
-    if (lines.size() > (size_t)max_lines) {
-        lines.erase(lines.begin(), lines.end() - max_lines);
+private:
+    static Color tagColor(uint32_t tags, Color none) {
+        if (tags & api::LOG_ERROR) return Color::Red;
+        if (tags & api::LOG_WARNING) return Color::Yellow;
+        return none;
     }
 
-    return lines;
-}
+    // One bucket of lines per row; the rows of the current page are brighter
+    void drawHeatmap(Screen& screen) {
+        Box column = box_;
+        column.x_min = box_.x_max;
+        DirectDraw draw(screen, column);
+        int rows = view_->page;
+        if (draw.empty() || rows <= 0 || count_ == 0) return;
 
-inline Component logView(const std::string& job_id, std::shared_ptr<bool> show_stderr,
-                         std::shared_ptr<float> scroll_y, std::function<void()> on_close) {
-    auto paths = api::slurm::getJobLogPaths(job_id);
-    auto stdout_path = std::make_shared<std::string>(paths.first);
-    auto stderr_path = std::make_shared<std::string>(paths.second);
-    auto stdout_lines = std::make_shared<std::vector<std::string>>(readLogFileLines(*stdout_path));
-    auto stderr_lines = std::make_shared<std::vector<std::string>>(readLogFileLines(*stderr_path));
-
-    auto log_content = Renderer([=] {
-        std::vector<Element> log_elements;
-        auto& lines = *show_stderr ? *stderr_lines : *stdout_lines;
-
-        int line_num = 1;
-        for (const auto& line : lines) {
-            std::string display_line = line;
-            if (display_line.length() > 120) {
-                display_line = display_line.substr(0, 117) + "...";
+        for (int r = 0; r < rows; ++r) {
+            size_t begin = count_ * (size_t)r / rows;
+            size_t end = std::max(begin + 1, count_ * (size_t)(r + 1) / rows);
+            if (begin >= count_) break;
+            uint32_t tags = source_.rangeTags(begin, end);
+            bool on_page = end > (size_t)view_->top && begin < (size_t)(view_->top + view_->page);
+            draw.put(box_.x_max, box_.y_min + r, tags ? "█" : (on_page ? "┃" : "│"),
+                     tagColor(tags, on_page ? Color::White : Color::GrayDark));
+        }
+    }
+
+    void highlightMatches(DirectDraw& draw, int y, std::string_view line) {
+        int width = DirectDraw::columns(highlight_);
+        for (size_t pos = line.find(highlight_); pos != std::string_view::npos; pos = line.find(highlight_, pos + 1)) {
+            int col = DirectDraw::columns(line.substr(0, pos)) - view_->left;
+            int w = width;
+            if (col < 0) {
+                w += col;
+                col = 0;
             }
-            log_elements.push_back(hbox({
-                text(std::to_string(line_num)) | dim | size(WIDTH, EQUAL, 5),
-                text(" "),
-                text(display_line),
-            }));
-            line_num++;
+            draw.invert(box_.x_min + gutter_ + col, y, w);
         }
+    }
 
-        return vbox(log_elements);
-    });
+    const api::LineSource& source_;
+    LogViewport* view_;
+    std::string highlight_;
+    size_t count_ = 0;
+    int gutter_ = 6;
+};
 
-    auto scrollable_content = Renderer(log_content, [=] {
-        return log_content->Render()
-               | focusPositionRelative(0.f, *scroll_y)
-               | frame
-               | size(HEIGHT, LESS_THAN, 25);
-    });
+// Search (/): the query being typed, then a background scan of the whole file
+struct LogSearch {
+    bool editing = false;
+    std::string input;
+    std::unique_ptr<api::TextSearch> scan;
+    size_t current = SIZE_MAX;     // Match shown last
+    bool jump_to_first = false;    // Show the first match as soon as it is found
+    std::string status;
+};
+
+// One stream (stdout or stderr) of the log view. The tail is shown at once;
+// a background line index gives whole-file access when complete or on a jump.
+// A compressed log has no cheap tail: it is browsed from the top while the
+// index decompresses it.
+struct LogStream {
+    std::string path;
+    api::Compression compression;
+    api::LogTail tail;
+    std::shared_ptr<api::LineIndex> index;     // Shared with later openings of the file
+    uint64_t subscription = 0;
+    std::unique_ptr<api::IndexedLog> indexed;  // Set once browsing the whole file
+    std::unique_ptr<api::LogFollower> follower;
+
+    explicit LogStream(std::string p)
+        : path(std::move(p)),
+          compression(api::detectCompression(path)),
+          tail(compression == api::Compression::None ? readLogTail(path) : compressedNotice(compression)) {}
+
+    ~LogStream() {
+        if (index) index->detach(subscription);
+    }
+
+    bool compressed() const { return compression != api::Compression::None; }
+
+    // Something to index or search: not missing, unreadable or empty
+    bool readable() const { return compressed() ? api::canDecompress(compression) : tail.fileSize() > 0; }
+
+    const api::LineSource& source() const {
+        if (follower) return *follower;
+        if (indexed && (!compressed() || index->lineCount() > 0 || index->complete())) return *indexed;
+        return tail;
+    }
+
+    // Index (or extend the index of) the file in the background
+    void startIndex(std::function<void()> on_update) {
+        if (!readable()) return;
+        if (!index) index = api::LineIndex::forFile(path);
+        subscription = index->update(std::move(on_update));
+        if (compressed() && !indexed) indexed = std::make_unique<api::IndexedLog>(index);
+    }
+
+    // Switch from the tail to the whole file. With keep_position the lines on
+    // screen stay the same (valid once the index reached the end of the tail).
+    bool useIndex(LogViewport& view, bool keep_position) {
+        if (indexed) return true;
+        if (!index) return false;
+        indexed = std::make_unique<api::IndexedLog>(index);
+        if (keep_position) {
+            uint64_t total = index->lineCount();
+            view.top += (int)(total - std::min<uint64_t>(total, tail.size()));
+        }
+        return true;
+    }
+};
+
+// on_update is called from background threads (follow mode, indexing) when
+// the view should be redrawn. With a start_line the view opens there (once
+// indexed that far), searching for `needle`.
+inline Component logView(const std::string& job_id, std::pair<std::string, std::string> paths,
+                         std::shared_ptr<bool> show_stderr, std::shared_ptr<LogViewport> view,
+                         std::function<void()> on_close, std::function<void()> on_update = {},
+                         int64_t start_line = -1, const std::string& needle = {}) {
+    auto out = std::make_shared<LogStream>(paths.first);
+    auto err = std::make_shared<LogStream>(paths.second);
+    auto stream = [=]() -> LogStream& { return *show_stderr ? *err : *out; };
+    stream().startIndex(on_update);
+
+    // Pending count for a jump, typed before G or %
+    auto jump = std::make_shared<std::string>();
+
+    // Follow mode (f): one watcher per stream, dropped when toggled off or closed
+    auto following = [=] { return out->follower || err->follower; };
+    auto stop_following = [=] {
+        out->follower.reset();
+        err->follower.reset();
+        view->follow_tail = false;
+    };
+    auto close = [=] {
+        stop_following();
+        on_close();
+    };
+
+    // Leave follow mode and show `line` of the whole file
+    auto go_to_line = [=](uint64_t line) {
+        if (following()) stop_following();
+        if (!stream().useIndex(*view, false)) return;
+        view->follow_tail = false;
+        view->top = (int)line;
+    };
+
+    auto search = std::make_shared<LogSearch>();
+    if (!needle.empty() && stream().readable()) {
+        search->input = needle;
+        search->scan = std::make_unique<api::TextSearch>(stream().path, needle, on_update);
+    }
+    auto pending_line = std::make_shared<int64_t>(start_line);
+
+    // e / E: next or previous error line of the whole file, from the last one shown
+    auto last_error = std::make_shared<int64_t>(-1);
+    auto step_error = [=](bool forward) {
+        auto& s = stream();
+        if (!s.index) return;
+        uint64_t current;
+        if (s.indexed) {
+            bool on_screen = *last_error >= view->top && *last_error < view->top + view->page;
+            current = on_screen ? (uint64_t)*last_error : (uint64_t)view->top;
+        } else {
+            // The tail sits at the end of the file, past whatever is indexed so far
+            uint64_t total = s.index->lineCount();
+            current = s.index->complete() ? total - std::min<uint64_t>(total, s.tail.size()) + view->top : total;
+        }
+        uint64_t line;
+        if (!s.index->nextError(current, forward, line)) return;
+        *last_error = (int64_t)line;
+        go_to_line(line - std::min<uint64_t>(line, (uint64_t)view->page / 3));
+    };
+
+    // Show match i a third of the way down the page
+    auto show_match = [=](size_t i) {
+        auto& s = stream();
+        uint64_t line = 0;
+        if (!s.index || !s.index->lineOfOffset(search->scan->match(i), line)) {
+            search->status = "indexing...";
+            return false;
+        }
+        search->current = i;
+        search->status.clear();
+        go_to_line(line - std::min<uint64_t>(line, (uint64_t)view->page / 3));
+        return true;
+    };
+
+    // n / N: next or previous match, wrapping around; the first jump starts from the screen
+    auto step_match = [=](bool forward) {
+        if (!search->scan) return false;
+        size_t count = search->scan->matchCount();
+        if (count == 0) {
+            search->status = search->scan->done() ? "no match" : "searching...";
+            return false;
+        }
+        size_t i;
+        if (search->current < count) {
+            i = forward ? (search->current + 1) % count : (search->current + count - 1) % count;
+        } else {
+            auto& s = stream();
+            uint64_t offset = s.tail.startOffset();
+            if (s.indexed) s.index->seek((uint64_t)view->top, offset);
+            i = search->scan->firstAtOrAfter(offset);
+            if (!forward) {
+                i = (i + count - 1) % count;
+            } else if (i >= count) {
+                // Later matches may still be found
+                if (!search->scan->done()) {
+                    search->status = "searching...";
+                    return false;
+                }
+                i = 0;
+            }
+        }
+        return show_match(i);
+    };
+
+    auto full_view = Renderer([=] {
+        auto& s = stream();
+        if (search->jump_to_first && search->scan && search->scan->matchCount() > 0 && step_match(true))
+            search->jump_to_first = false;
+        if (*pending_line >= 0 && view->page > 0 && s.index &&
+            (s.index->lineCount() > (uint64_t)*pending_line || s.index->complete())) {
+            uint64_t line = (uint64_t)*pending_line;
+            *pending_line = -1;
+            go_to_line(line - std::min<uint64_t>(line, (uint64_t)view->page / 3));
+        }
+        // The index caught up: keep the same lines on screen, now with the whole file behind them
+        if (!s.indexed && s.index && s.index->complete()) s.useIndex(*view, !following());
+
+        int total_lines = s.source().lineCount();
+        std::string count_label = (!s.indexed && !s.follower && s.tail.startOffset() > 0 ? "last " : "") +
+                                  std::to_string(total_lines) + " lines";
+
+        Element search_label = text("");
+        if (search->editing) {
+            search_label = text("/" + search->input + "█  ") | bold | color(Color::Yellow);
+        } else if (search->scan) {
+            auto& scan = *search->scan;
+            std::string label = "/" + scan.needle() + "  ";
+            size_t count = scan.matchCount();
+            if (search->current < count) label += std::to_string(search->current + 1) + "/";
+            label += std::to_string(count) + (count == 1 ? " match" : " matches");
+            if (!scan.done() && scan.fileSize() > 0)
+                label += " (" + std::to_string(100 * scan.scannedBytes() / scan.fileSize()) + "%)";
+            if (!search->status.empty()) label += " " + search->status;
+            search_label = text(label + "  ") | color(Color::Yellow);
+        }
+
+        Element errors = text("");
+        if (s.index && s.index->errorCount() > 0)
+            errors = text(std::to_string(s.index->errorCount()) + " errors  ") | color(Color::Red);
 
-    auto full_view = Renderer(scrollable_content, [=] {
-        std::string current_path = *show_stderr ? *stderr_path : *stdout_path;
-        auto& lines = *show_stderr ? *stderr_lines : *stdout_lines;
-        int total_lines = lines.size();
-        int scroll_percent = (int)(*scroll_y * 100);
+        Element indexing = text("");
+        if (s.index && s.index->indexing()) {
+            int pct = s.index->progress();
+            indexing = text((s.compressed() ? "decompressing " : "indexing ") + std::to_string(pct) + "%  ") | dim;
+        }
 
         return vbox({
             hbox({
@@ -97,24 +386,41 @@ inline Component logView(const std::string& job_id, std::shared_ptr<bool> show_s
                 text("  |  "),
                 (*show_stderr ? text("[stderr]") | bold | color(Color::Red) : text("[stderr]") | dim),
                 filler(),
-                text(std::to_string(total_lines) + " lines") | dim,
+                search_label,
+                (jump->empty() ? text("") : text(":" + *jump + "  ") | bold | color(Color::Yellow)),
+                (following() ? text("● FOLLOW  ") | bold | color(Color::Green) : text("")),
+                errors,
+                indexing,
+                (view->left > 0 ? text("col " + std::to_string(view->left + 1) + "  ") | dim : text("")),
+                text(count_label) | dim,
                 text("  "),
-                text(std::to_string(scroll_percent) + "%") | color(Color::Yellow),
+                text(std::to_string(view->percent()) + "%") | color(Color::Yellow),
                 text("  "),
             }),
             separator(),
             hbox({
                 text("File: ") | dim,
-                text(current_path) | color(Color::Cyan),
+                text(s.path) | color(Color::Cyan),
             }),
             separator(),
-            scrollable_content->Render() | flex,
+            std::make_shared<LogLines>(s.source(), view.get(),
+                                       search->scan ? search->scan->needle() : std::string()) | flex,
             separator(),
             hbox({
-                text("↑↓/Wheel") | bold | color(Color::Yellow),
+                text("↑↓/Wheel/PgUp/PgDn") | bold | color(Color::Yellow),
                 text(": scroll  ") | dim,
+                text("←→") | bold | color(Color::Yellow),
+                text(": pan  ") | dim,
+                text("/ n N") | bold | color(Color::Yellow),
+                text(": search  ") | dim,
+                text("123G/50%") | bold | color(Color::Yellow),
+                text(": jump  ") | dim,
+                text("e E") | bold | color(Color::Yellow),
+                text(": errors  ") | dim,
                 text("Tab") | bold | color(Color::Yellow),
                 text(": stdout/stderr  ") | dim,
+                text("f") | bold | color(Color::Yellow),
+                text(": follow  ") | dim,
                 text("Esc") | bold | color(Color::Yellow),
                 text(": close") | dim,
             }) | center,
@@ -122,40 +428,142 @@ inline Component logView(const std::string& job_id, std::shared_ptr<bool> show_s
     });
 
     return CatchEvent(full_view, [=](Event e) {
-        constexpr float scroll_step = 0.05f;
+        // Search prompt takes every key until Enter or Escape
+        if (search->editing) {
+            if (e == Event::Return) {
+                search->editing = false;
+                search->current = SIZE_MAX;
+                search->status.clear();
+                search->scan.reset();
+                if (!search->input.empty() && stream().readable()) {
+                    search->scan = std::make_unique<api::TextSearch>(stream().path, search->input, on_update);
+                    search->jump_to_first = true;
+                }
+            } else if (e == Event::Escape) {
+                search->editing = false;
+            } else if (e == Event::Backspace) {
+                if (!search->input.empty()) search->input.pop_back();
+            } else if (e.is_character()) {
+                search->input += e.character();
+            }
+            return true;
+        }
+        if (e == Event::Character('/')) {
+            search->editing = true;
+            search->input.clear();
+            return true;
+        }
+        if (e == Event::Character('n')) {
+            search->jump_to_first = false;
+            step_match(true);
+            return true;
+        }
+        if (e == Event::Character('N')) {
+            search->jump_to_first = false;
+            step_match(false);
+            return true;
+        }
+
+        if (e == Event::Character('e')) { step_error(true); return true; }
+        if (e == Event::Character('E')) { step_error(false); return true; }
+
+        // Any vertical move re-pins to the tail only if it lands on the last page
+        auto scrolled = [&] {
+            view->follow_tail = following() && view->atEnd();
+            return true;
+        };
 
-        // Mouse wheel scrolling
         if (e.is_mouse()) {
-            if (e.mouse().button == Mouse::WheelDown) {
-                *scroll_y = std::min(*scroll_y + scroll_step, 1.f);
-                return true;
-            }
-            if (e.mouse().button == Mouse::WheelUp) {
-                *scroll_y = std::max(*scroll_y - scroll_step, 0.f);
-                return true;
-            }
+            if (e.mouse().button == Mouse::WheelDown) { view->scrollBy(3); return scrolled(); }
+            if (e.mouse().button == Mouse::WheelUp) { view->scrollBy(-3); return scrolled(); }
+            return false;
         }
 
-        // Arrow keys for scrolling
-        if (e == Event::ArrowDown) {
-            *scroll_y = std::min(*scroll_y + scroll_step, 1.f);
+        if (e == Event::ArrowDown) { view->scrollBy(1); return scrolled(); }
+        if (e == Event::ArrowUp) { view->scrollBy(-1); return scrolled(); }
+        if (e == Event::PageDown) { view->pageDown(); return scrolled(); }
+        if (e == Event::PageUp) { view->pageUp(); return scrolled(); }
+        if (e == Event::Home) { view->home(); return scrolled(); }
+        if (e == Event::End) { view->end(); return scrolled(); }
+
+        if (e == Event::ArrowRight) {
+            view->left += 8;
             return true;
         }
-        if (e == Event::ArrowUp) {
-            *scroll_y = std::max(*scroll_y - scroll_step, 0.f);
+        if (e == Event::ArrowLeft) {
+            view->left = std::max(0, view->left - 8);
+            return true;
+        }
+
+        // Jumps: a count followed by G (line) or % (position in the file)
+        if (e.is_character() && e.character().size() == 1 && std::isdigit((unsigned char)e.character()[0])) {
+            if (jump->size() < 12) *jump += e.character();
+            return true;
+        }
+        if (e == Event::Backspace && !jump->empty()) {
+            jump->pop_back();
+            return true;
+        }
+        if (e == Event::Character('G')) {
+            uint64_t n = jump->empty() ? 0 : std::stoull(*jump);
+            jump->clear();
+            if (n == 0) {
+                view->end();
+                return scrolled();
+            }
+            go_to_line(n - 1);
+            return true;
+        }
+        if (e == Event::Character('%') && !jump->empty()) {
+            uint64_t pct = std::min<uint64_t>(100, std::stoull(*jump));
+            jump->clear();
+            auto& s = stream();
+            if (!s.index) return true;
+            uint64_t total = s.index->lineCount();
+            uint64_t line = 0;
+            if (s.index->complete()) {
+                line = total * pct / 100;
+            } else {
+                // Not indexed yet: locate the byte position, or stop at the indexed part
+                uint64_t size = s.index->fileSize();
+                uint64_t byte = size * pct / 100;
+                line = size > 0 && byte <= s.index->indexedBytes() ? s.index->lineAtOffset(byte) : total;
+            }
+            go_to_line(std::min(line, total > 0 ? total - 1 : 0));
             return true;
         }
 
         // Tab to switch stdout/stderr
         if (e == Event::Tab || e == Event::TabReverse) {
             *show_stderr = !*show_stderr;
-            *scroll_y = 0.f;  // Reset scroll on switch
+            stream().startIndex(on_update);
+            search->scan.reset();  // Matches belong to the other file
+            *pending_line = -1;
+            view->top = 0;  // Reset scroll on switch
+            view->left = 0;
+            view->follow_tail = following();
+            return true;
+        }
+
+        // Toggle follow mode; starts pinned to the bottom
+        if (e == Event::Character('f') || e == Event::Character('F')) {
+            if (following()) {
+                stop_following();
+            } else {
+                out->follower = followLog(out->path, on_update);
+                err->follower = followLog(err->path, on_update);
+                view->follow_tail = following();
+            }
             return true;
         }
 
-        // Close on Escape or Enter (but not on other characters to allow scrolling)
+        // Escape cancels a pending jump first; Escape or Enter closes
+        if (e == Event::Escape && !jump->empty()) {
+            jump->clear();
+            return true;
+        }
         if (e == Event::Escape || e == Event::Return) {
-            on_close();
+            close();
             return true;
         }
 
@@ -163,4 +571,11 @@ inline Component logView(const std::string& job_id, std::shared_ptr<bool> show_s
     });
 }
 
+inline Component logView(const std::string& job_id, std::shared_ptr<bool> show_stderr,
+                         std::shared_ptr<LogViewport> view, std::function<void()> on_close,
+                         std::function<void()> on_update = {}) {
+    return logView(job_id, api::slurm::getJobLogPaths(job_id), std::move(show_stderr), std::move(view),
+                   std::move(on_close), std::move(on_update));
+}
+
 }
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <ftxui/component/component.hpp>
+#include <ftxui/dom/elements.hpp>
+#include <chrono>
+#include <set>
+#include "../api/slurmjobs.hpp"
+#include "../api/log_multiplexer.hpp"
+#include "../api/snapshot_cache.hpp"
+#include "log_view.hpp"
+
+namespace ui {
+using namespace ftxui;
+
+// Files of a merged view: stdout of every job, and stderr when it goes elsewhere.
+// Array tasks are labelled by task id, other jobs by job id.
+inline std::vector<api::LogMultiplexer::Source> multiLogSources(const std::vector<api::JobLogs>& jobs) {
+    std::vector<api::LogMultiplexer::Source> sources;
+    std::set<std::string> seen;
+    for (const auto& job : jobs) {
+        std::string label = job.array_task.empty() ? job.id : job.array_task;
+        for (const auto& [path, suffix] : {std::make_pair(job.stdout_path, ""), std::make_pair(job.stderr_path, " err")}) {
+            if (path.empty() || path == "(null)" || !seen.insert(path).second) continue;
+            sources.push_back({label + suffix, path});
+        }
+    }
+    return sources;
+}
+
+// Live logs of every task of a job array (or every job of a sweep) in one
+// view, interleaved as they are written. `user` owns the job (the current
+// user when empty). The view opens at once: squeue runs on a worker, and the
+// files are watched once it answered.
+inline Component multiLogView(const std::string& job_id, const std::string& user, std::shared_ptr<LogViewport> view,
+                              std::function<void()> on_close, std::function<void()> on_update = {}) {
+    // Dropped with the component: waits for squeue without calling on_update
+    auto related = std::make_shared<api::SnapshotCache<std::vector<api::JobLogs>>>(
+        [job_id, user] { return api::slurm::getRelatedJobLogs(job_id, user); }, std::chrono::hours(24));
+    related->refreshAsync(on_update);
+
+    struct State {
+        std::string title;
+        std::shared_ptr<api::LogMultiplexer> mux;  // Null until squeue answered; dropped with the component
+    };
+    auto state = std::make_shared<State>();
+    state->title = job_id;
+    view->follow_tail = true;
+
+    // Starts watching the files once the job set is known
+    auto load = [=] {
+        if (state->mux) return true;
+        auto jobs = related->get();
+        if (!jobs) return false;
+        if (!jobs->empty())
+            state->title = (*jobs)[0].array_task.empty() ? (*jobs)[0].name : "array " + job_id.substr(0, job_id.find('_'));
+        state->mux = std::make_shared<api::LogMultiplexer>(multiLogSources(*jobs), on_update);
+        state->mux->start();
+        return true;
+    };
+
+    // Tab cycles through the sources (-1: all of them), e keeps flagged lines only
+    auto source = std::make_shared<int>(-1);
+    auto flagged = std::make_shared<bool>(false);
+    auto apply_filter = [=] {
+        state->mux->setFilter(*source, *flagged);
+        view->top = 0;
+        view->follow_tail = true;
+    };
+
+    auto full_view = Renderer([=] {
+        auto title_bar = hbox({
+            text("═══ LIVE LOGS: ") | color(Color::Cyan),
+            text(state->title) | bold | color(Color::Magenta),
+            text(" ═══") | color(Color::Cyan),
+        }) | center;
+        if (!load()) {
+            return vbox({
+                title_bar,
+                separator(),
+                text("  loading the jobs of the set (squeue)...") | dim,
+                filler(),
+                separator(),
+                hbox({text("Esc") | bold | color(Color::Yellow), text(": close") | dim}) | center,
+            }) | border | size(WIDTH, LESS_THAN, 130);
+        }
+        const auto& mux = state->mux;
+        int total_lines = (int)mux->lineCount();
+        size_t failing = mux->failingCount();
+
+        Element shown = text("all " + std::to_string(mux->sourceCount()) + " files (" +
+                             std::to_string(mux->openedCount()) + " found)") | color(Color::Cyan);
+        if (mux->sourceCount() == 0) {
+            shown = text("no queued job found") | dim;
+        } else if (*source >= 0) {
+            shown = hbox({
+                text(mux->label(*source)) | bold | color(Color::Magenta),
+                text("  " + mux->path(*source)) | color(Color::Cyan),
+                text("  (" + std::to_string(*source + 1) + "/" + std::to_string(mux->sourceCount()) + ")") | dim,
+            });
+        }
+
+        return vbox({
+            title_bar,
+            separator(),
+            hbox({
+                text("  "),
+                shown,
+                filler(),
+                (*flagged ? text("errors/warnings only  ") | bold | color(Color::Yellow) : text("")),
+                (failing > 0 ? text(std::to_string(failing) + " with errors  ") | color(Color::Red) : text("")),
+                (view->follow_tail ? text("● LIVE  ") | bold | color(Color::Green) : text("")),
+                text(std::to_string(total_lines) + " lines") | dim,
+                text("  "),
+                text(std::to_string(view->percent()) + "%") | color(Color::Yellow),
+                text("  "),
+            }),
+            separator(),
+            std::make_shared<LogLines>(*mux, view.get()) | flex,
+            separator(),
+            hbox({
+                text("↑↓/Wheel/PgUp/PgDn") | bold | color(Color::Yellow),
+                text(": scroll  ") | dim,
+                text("←→") | bold | color(Color::Yellow),
+                text(": pan  ") | dim,
+                text("Tab") | bold | color(Color::Yellow),
+                text(": one file/all  ") | dim,
+                text("e") | bold | color(Color::Yellow),
+                text(": errors only  ") | dim,
+                text("End") | bold | color(Color::Yellow),
+                text(": live  ") | dim,
+                text("Esc") | bold | color(Color::Yellow),
+                text(": close") | dim,
+            }) | center,
+        }) | border | size(WIDTH, LESS_THAN, 130);
+    });
+
+    return CatchEvent(full_view, [=](Event e) {
+        if (!state->mux) {
+            if (e != Event::Escape && e != Event::Return) return false;
+            on_close();
+            return true;
+        }
+        const auto& mux = state->mux;
+
+        // Scrolling away from the bottom pauses, coming back resumes
+        auto scrolled = [&] {
+            view->follow_tail = view->atEnd();
+            return true;
+        };
+
+        if (e.is_mouse()) {
+            if (e.mouse().button == Mouse::WheelDown) { view->scrollBy(3); return scrolled(); }
+            if (e.mouse().button == Mouse::WheelUp) { view->scrollBy(-3); return scrolled(); }
+            return false;
+        }
+
+        if (e == Event::ArrowDown) { view->scrollBy(1); return scrolled(); }
+        if (e == Event::ArrowUp) { view->scrollBy(-1); return scrolled(); }
+        if (e == Event::PageDown) { view->pageDown(); return scrolled(); }
+        if (e == Event::PageUp) { view->pageUp(); return scrolled(); }
+        if (e == Event::Home) { view->home(); return scrolled(); }
+        if (e == Event::End) { view->end(); return scrolled(); }
+
+        if (e == Event::ArrowRight) {
+            view->left += 8;
+            return true;
+        }
+        if (e == Event::ArrowLeft) {
+            view->left = std::max(0, view->left - 8);
+            return true;
+        }
+
+        int count = (int)mux->sourceCount();
+        if ((e == Event::Tab || e == Event::TabReverse) && count > 0) {
+            // -1 (all), 0 .. count - 1, then back to all
+            int step = e == Event::Tab ? 1 : count;
+            *source = (*source + 1 + step) % (count + 1) - 1;
+            apply_filter();
+            return true;
+        }
+        if (e == Event::Character('e') || e == Event::Character('E')) {
+            *flagged = !*flagged;
+            apply_filter();
+            return true;
+        }
+
+        if (e == Event::Escape || e == Event::Return) {
+            mux->stop();
+            on_close();
+            return true;
+        }
+        return false;
+    });
+}
+
+}
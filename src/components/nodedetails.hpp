@@ -2,20 +2,15 @@
 
 #include <ftxui/component/component.hpp>
 #include <ftxui/dom/elements.hpp>
+#include <algorithm>
 #include <map>
-#include <regex>
 #include "../api/slurmjobs.hpp"
+#include "direct_draw.hpp"
+#include "viewport.hpp"
 
 namespace ui {
 using namespace ftxui;
 
-// Extract APU prefix from node name by removing trailing digits
-// e.g., "romeo-a057" → "romeo-a", "romeo-gpu01" → "romeo-gpu"
-inline std::string extractApuPrefix(const std::string& node_name) {
-    std::regex re(R"([0-9]+$)");
-    return std::regex_replace(node_name, re, "");
-}
-
 // Convert APU prefix to readable name (matching ROMEO cluster naming)
 inline std::string getApuDisplayName(const std::string& prefix) {
     static const std::map<std::string, std::string> apu_names = {
@@ -45,153 +40,264 @@ struct ApuGroup {
     int total_gpus = 0;
 };
 
-// Render a single node cell
-inline Element renderNodeCell(const api::NodeAllocation& node) {
-    Element title = text(node.node_name) | color(Color::Cyan) | bold;
-
-    const int cores_per_line = 20;
-    std::vector<Element> core_lines;
-    int line_count = 0;
-    std::vector<Element> current_line;
-
-    current_line.push_back(text("Coeurs : "));
-
-    for (int i = 0; i < node.total_cores; ++i) {
-        if (std::find(node.allocated_cores.begin(), node.allocated_cores.end(), i) != node.allocated_cores.end())
-            current_line.push_back(text("■") | color(Color::Green));
-        else
-            current_line.push_back(text("."));
-
-        line_count++;
-        if (line_count == cores_per_line) {
-            core_lines.push_back(hbox(current_line));
-            current_line.clear();
-            current_line.push_back(text("         ")); // 9 spaces to align with "Coeurs : "
-            line_count = 0;
+// Group nodes by APU prefix (precomputed at parse time), sorted by prefix.
+// Groups point into job.node_allocations and must not outlive it.
+inline std::vector<ApuGroup> groupNodesByApu(const api::DetailedJob& job) {
+    std::map<std::string, ApuGroup> groups;
+
+    for (const auto& node : job.node_allocations) {
+        auto it = groups.find(node.node_prefix);
+        if (it == groups.end()) {
+            it = groups.emplace(node.node_prefix, ApuGroup{
+                node.node_prefix,
+                getApuDisplayName(node.node_prefix),
+                {},
+                0, 0, 0, 0
+            }).first;
         }
-    }
 
-    if (!current_line.empty()) {
-        while (line_count < cores_per_line) {
-            current_line.push_back(text("."));
-            line_count++;
-        }
-        core_lines.push_back(hbox(current_line));
+        auto& group = it->second;
+        group.nodes.push_back(&node);
+        group.total_allocated_cores += node.allocated_cores.count();
+        group.total_cores += node.total_cores;
+        group.total_allocated_gpus += node.allocated_gpus.count();
+        group.total_gpus += node.total_gpus;
     }
 
-    Element cores_box = vbox(core_lines);
-
-    std::vector<Element> gpu_line;
-    gpu_line.push_back(text("GPUs   : "));
-    for (int i = 0; i < node.total_gpus; ++i) {
-        if (i < node.allocated_gpus)
-            gpu_line.push_back(text("● ") | color(Color::Yellow));
-        else
-            gpu_line.push_back(text("○ "));
-    }
-
-    if (node.total_gpus == 0) {
-        gpu_line.push_back(text("None"));
-    }
-
-    Element gpu_box = hbox(gpu_line);
-
-    return hbox({
-        hbox({
-            text("  "),
-            vbox({
-                title,
-                cores_box,
-                text(" "),
-                gpu_box
-            }),
-            text("  ")
-        }) | border,
-        text("  ")
-    });
-}
-
-// Render APU group header with statistics (matching bash script style)
-inline Element renderApuHeader(const ApuGroup& group) {
-    std::string stats = "Noeuds: " + std::to_string(group.nodes.size()) +
-                        " | Coeurs alloués: " + std::to_string(group.total_allocated_cores) +
-                        " | GPUs alloués: " + std::to_string(group.total_allocated_gpus);
-
-    return vbox({
-        text(""),
-        text("╔══════════════════════════════════════════════════════════╗") | color(Color::Magenta) | bold,
-        hbox({
-            text("║ ") | color(Color::Magenta) | bold,
-            text(group.display_name) | bold,
-        }),
-        hbox({
-            text("║ ") | color(Color::Magenta) | bold,
-            text(stats) | color(Color::Cyan),
-        }),
-        text("╚══════════════════════════════════════════════════════════╝") | color(Color::Magenta) | bold,
-    });
+    std::vector<ApuGroup> result;
+    result.reserve(groups.size());
+    for (auto& [prefix, group] : groups) result.push_back(std::move(group));
+    return result;
 }
 
-inline Component nodedetails(const api::DetailedJob& job, int width) {
-    using namespace ftxui;
+class NodeGrid;
 
-    return Renderer([job, width] {
-        // Group nodes by APU prefix
-        std::map<std::string, ApuGroup> groups;
+// Scroll state of the node panel. It outlives the (memoized) NodeGrid element
+// and is updated by it on every layout, so event handlers can page and jump.
+struct NodeGridView : LineViewport {
+    const NodeGrid* grid = nullptr;
 
-        for (const auto& node : job.node_allocations) {
-            std::string prefix = extractApuPrefix(node.node_name);
+    // Scroll to the first node whose name contains `query`. Returns false if none.
+    bool jumpTo(const std::string& query);
+};
 
-            if (groups.find(prefix) == groups.end()) {
-                groups[prefix] = ApuGroup{
-                    prefix,
-                    getApuDisplayName(prefix),
-                    {},
-                    0, 0, 0, 0
-                };
+// Draws the node panel straight into the screen buffer: one header per APU
+// group followed by a grid of node cells. Only the lines inside the viewport
+// [view.top, view.top + height) are drawn, and every position is computed
+// arithmetically from the group geometry, so the cost of a frame does not
+// depend on how many nodes the job spans.
+class NodeGrid : public Node {
+public:
+    static constexpr int cores_per_line = 20;
+    static constexpr int header_height = 5;
+    static constexpr int header_width = 60;
+    static constexpr int label_width = 9;  // "Coeurs : " / "GPUs   : "
+
+    NodeGrid(std::vector<ApuGroup> groups, NodeGridView* view)
+        : groups_(std::move(groups)), view_(view) {
+        for (const auto& group : groups_) {
+            GroupLayout g;
+            int max_cores = 0, max_gpus = 0, max_name = 0;
+            for (const auto* node : group.nodes) {
+                max_cores = std::max(max_cores, node->total_cores);
+                max_gpus = std::max(max_gpus, node->total_gpus);
+                max_name = std::max(max_name, (int)node->node_name.size());
             }
 
-            auto& group = groups[prefix];
-            group.nodes.push_back(&node);
-            group.total_allocated_cores += node.allocated_cores.size();
-            group.total_cores += node.total_cores;
-            group.total_allocated_gpus += node.allocated_gpus;
-            group.total_gpus += node.total_gpus;
+            // Cell: border, 2 spaces, content, 2 spaces, border, then 2 spaces of gap
+            g.core_lines = std::max(1, (max_cores + cores_per_line - 1) / cores_per_line);
+            g.content_width = std::max({label_width + cores_per_line, label_width + std::max(4, 2 * max_gpus), max_name});
+            g.cell_width = g.content_width + 6;
+            g.cell_height = g.core_lines + 5;
+            layouts_.push_back(g);
         }
+        view_->grid = this;
+    }
 
-        // Build the display
-        std::vector<Element> all_elements;
-        const int cell_width = 44;
-        int nodes_per_row = std::max(1, width / cell_width);
+    ~NodeGrid() override {
+        if (view_->grid == this) view_->grid = nullptr;
+    }
 
-        for (auto& [prefix, group] : groups) {
-            // Add APU header
-            all_elements.push_back(renderApuHeader(group));
+    void ComputeRequirement() override {
+        requirement_.min_x = 0;
+        requirement_.min_y = 0;
+        requirement_.flex_grow_x = 1;
+        requirement_.flex_grow_y = 1;
+        requirement_.flex_shrink_x = 1;
+        requirement_.flex_shrink_y = 1;
+    }
 
-            // Add nodes in grid layout
-            std::vector<std::vector<Element>> rows;
-            std::vector<Element> row;
-            int count = 0;
+    void SetBox(Box box) override {
+        int width = box.x_max - box.x_min + 1;
+        if (width != layout_width_) layout(width);
+        Node::SetBox(box);
 
-            for (const auto* node : group.nodes) {
-                row.push_back(renderNodeCell(*node));
-                count++;
+        view_->grid = this;
+        view_->content = height_;
+        view_->page = box.y_max - box.y_min + 1;
+        view_->scrollTo(view_->top);
+    }
+
+    // First line of the cell of the first node whose name contains `query`, or -1
+    int lineOf(const std::string& query) const {
+        for (size_t i = 0; i < groups_.size(); ++i) {
+            const auto& nodes = groups_[i].nodes;
+            const auto& g = layouts_[i];
+            for (size_t n = 0; n < nodes.size(); ++n) {
+                if (nodes[n]->node_name.find(query) != std::string::npos)
+                    return g.y + header_height + (int)n / g.nodes_per_row * g.cell_height;
+            }
+        }
+        return -1;
+    }
 
-                if (count % nodes_per_row == 0) {
-                    rows.push_back(row);
-                    row.clear();
+    void Render(Screen& screen) override {
+        DirectDraw draw(screen, box_);
+        if (draw.empty()) return;
+        const Box& clip = draw.clip;
+
+        // Content line L is drawn at screen row origin + L
+        int origin = box_.y_min - view_->top;
+
+        for (size_t i = 0; i < groups_.size(); ++i) {
+            const auto& group = groups_[i];
+            const auto& g = layouts_[i];
+            int top = origin + g.y;
+            if (top > clip.y_max) break;
+            if (top + header_height + g.rows * g.cell_height <= clip.y_min) continue;
+
+            drawHeader(draw, group, top);
+
+            // Only rows intersecting the viewport are drawn
+            int grid_top = top + header_height;
+            int first_row = std::max(0, (clip.y_min - grid_top) / g.cell_height);
+            int last_row = std::min(g.rows - 1, (clip.y_max - grid_top) / g.cell_height);
+            for (int row = first_row; row <= last_row; ++row) {
+                for (int col = 0; col < g.nodes_per_row; ++col) {
+                    size_t n = (size_t)(row * g.nodes_per_row + col);
+                    if (n >= group.nodes.size()) break;
+                    drawCell(draw, *group.nodes[n], g,
+                             box_.x_min + col * (g.cell_width + 2),
+                             grid_top + row * g.cell_height);
                 }
             }
+        }
+    }
+
+private:
+    struct GroupLayout {
+        int y = 0;              // First line of the group header, in content lines
+        int core_lines = 1;
+        int content_width = 0;
+        int cell_width = 0;
+        int cell_height = 0;
+        int nodes_per_row = 1;
+        int rows = 0;
+    };
+
+    // Place groups and rows for a given width: O(number of groups)
+    void layout(int width) {
+        int y = 0;
+        for (size_t i = 0; i < groups_.size(); ++i) {
+            auto& g = layouts_[i];
+            g.nodes_per_row = std::max(1, width / (g.cell_width + 2));
+            g.rows = ((int)groups_[i].nodes.size() + g.nodes_per_row - 1) / g.nodes_per_row;
+            g.y = y;
+            y += header_height + g.rows * g.cell_height;
+        }
+        height_ = y;
+        layout_width_ = width;
+    }
+
+    void drawHeader(DirectDraw& draw, const ApuGroup& group, int top) {
+        std::string stats = "Noeuds: " + std::to_string(group.nodes.size()) +
+                            " | Coeurs alloués: " + std::to_string(group.total_allocated_cores) +
+                            " | GPUs alloués: " + std::to_string(group.total_allocated_gpus);
+        int x = box_.x_min;
+
+        draw.put(x, top + 1, "╔", Color::Magenta, true);
+        draw.put(x, top + 4, "╚", Color::Magenta, true);
+        for (int i = 1; i < header_width - 1; ++i) {
+            draw.put(x + i, top + 1, "═", Color::Magenta, true);
+            draw.put(x + i, top + 4, "═", Color::Magenta, true);
+        }
+        draw.put(x + header_width - 1, top + 1, "╗", Color::Magenta, true);
+        draw.put(x + header_width - 1, top + 4, "╝", Color::Magenta, true);
+
+        draw.text(x, top + 2, "║ ", Color::Magenta, true);
+        draw.text(x + 2, top + 2, group.display_name, Color::Default, true);
+        draw.text(x, top + 3, "║ ", Color::Magenta, true);
+        draw.text(x + 2, top + 3, stats, Color::Cyan);
+    }
 
-            if (!row.empty()) rows.push_back(row);
+    void drawCell(DirectDraw& draw, const api::NodeAllocation& node, const GroupLayout& g, int x0, int y0) {
+        if (y0 > draw.clip.y_max || y0 + g.cell_height <= draw.clip.y_min) return;
+        int x1 = x0 + g.cell_width - 1;
+        int y1 = y0 + g.cell_height - 1;
+
+        // Border
+        draw.put(x0, y0, "┌");
+        draw.put(x1, y0, "┐");
+        draw.put(x0, y1, "└");
+        draw.put(x1, y1, "┘");
+        for (int x = x0 + 1; x < x1; ++x) {
+            draw.put(x, y0, "─");
+            draw.put(x, y1, "─");
+        }
+        for (int y = y0 + 1; y < y1; ++y) {
+            draw.put(x0, y, "│");
+            draw.put(x1, y, "│");
+        }
 
-            if (!rows.empty()) {
-                all_elements.push_back(gridbox(rows));
+        int cx = x0 + 3;
+        int y = y0 + 1;
+        draw.text(cx, y++, node.node_name, Color::Cyan, true);
+
+        // Cores, straight from the allocation bitset
+        for (int line = 0; line < g.core_lines; ++line, ++y) {
+            if (line == 0) draw.text(cx, y, "Coeurs : ");
+            int x = cx + label_width;
+            for (int k = 0; k < cores_per_line; ++k, ++x) {
+                int core = line * cores_per_line + k;
+                if (core < node.total_cores && node.allocated_cores.contains(core))
+                    draw.put(x, y, "■", Color::Green);
+                else
+                    draw.put(x, y, ".");
             }
         }
 
-        return vbox(all_elements);
-    });
+        y++;
+        draw.text(cx, y, "GPUs   : ");
+        int x = cx + label_width;
+        if (node.total_gpus == 0) {
+            draw.text(x, y, "None");
+        }
+        for (int i = 0; i < node.total_gpus; ++i, x += 2) {
+            if (node.allocated_gpus.contains(i))
+                draw.put(x, y, "●", Color::Yellow);
+            else
+                draw.put(x, y, "○");
+        }
+    }
+
+    std::vector<ApuGroup> groups_;
+    std::vector<GroupLayout> layouts_;
+    NodeGridView* view_;
+    int layout_width_ = -1;
+    int height_ = 0;
+};
+
+inline bool NodeGridView::jumpTo(const std::string& query) {
+    int line = grid && !query.empty() ? grid->lineOf(query) : -1;
+    if (line < 0) return false;
+    scrollTo(line);
+    return true;
 }
 
-}
\ No newline at end of file
+// Build the whole node panel. Groups point into job.node_allocations, so the
+// element must not outlive the job snapshot (see RenderCache).
+inline Element nodeGrid(const api::DetailedJob& job, NodeGridView* view) {
+    return std::make_shared<NodeGrid>(groupNodesByApu(job), view);
+}
+
+}
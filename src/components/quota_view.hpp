@@ -2,24 +2,41 @@
 
 #include <ftxui/component/component.hpp>
 #include <ftxui/dom/elements.hpp>
-#include <sstream>
-#include <regex>
+#include <chrono>
 #include <cstdlib>
-#include "../api/slurmjobs.hpp"
+#include <map>
+#include <sstream>
+#include "../api/job_table.hpp"
+#include "../api/snapshot_cache.hpp"
 
 namespace ui {
 using namespace ftxui;
 
+// Association limits from sacctmgr. They almost never change, so they are
+// cached for a long time and fetched in the background; usage comes from the
+// job snapshot of the main view instead of more squeue calls.
+struct QuotaLimits {
+    std::string account;
+    std::map<std::string, int64_t> tres;  // "cpu", "node", "mem" (MB), "gres/gpu", "billing", ...
+    int max_jobs = 0;
+};
+
 struct UserQuota {
     std::string user;
     std::string account;
-    int max_cpus = 0;
-    int max_nodes = 0;
+    std::map<std::string, int64_t> limits;  // TRES limits, as in QuotaLimits
     int max_jobs = 0;
-    int used_cpus = 0;
-    int used_nodes = 0;
+    int64_t used_cpus = 0;
+    int64_t used_nodes = 0;
+    int64_t used_mem_mb = 0;
+    int64_t used_gpus = 0;
     int running_jobs = 0;
     int pending_jobs = 0;
+
+    int64_t limit(const std::string& tres) const {
+        auto it = limits.find(tres);
+        return it == limits.end() ? 0 : it->second;
+    }
 };
 
 inline std::string execCmd(const std::string& cmd) {
@@ -36,15 +53,27 @@ inline std::string execCmd(const std::string& cmd) {
     return result;
 }
 
-inline UserQuota getUserQuota() {
-    UserQuota quota;
-
+inline const char* quotaUser() {
     const char* user = std::getenv("USER");
-    if (!user) user = "unknown";
-    quota.user = user;
+    return user ? user : "unknown";
+}
+
+// "cpu=512,mem=2000G,gres/gpu=8" into `tres`; memory in MB
+inline void parseTresList(const std::string& list, std::map<std::string, int64_t>& tres) {
+    std::istringstream iss(list);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == std::string::npos || eq + 1 >= item.size()) continue;
+        std::string key = item.substr(0, eq);
+        std::string value = item.substr(eq + 1);
+        tres[key] = key == "mem" ? api::slurm::parseMemoryMB(value) : std::strtoll(value.c_str(), nullptr, 10);
+    }
+}
 
-    // Get association limits from sacctmgr
-    std::string cmd = "sacctmgr show Association where user=" + std::string(user) +
+inline QuotaLimits getQuotaLimits() {
+    QuotaLimits limits;
+    std::string cmd = "sacctmgr show Association where user=" + std::string(quotaUser()) +
                       " format=User,Account,GrpTRES,MaxTRES,GrpJobs,MaxJobs -P --noheader 2>/dev/null";
     std::string out = execCmd(cmd);
 
@@ -62,66 +91,69 @@ inline UserQuota getUserQuota() {
         }
 
         if (fields.size() >= 2) {
-            quota.account = fields[1];
+            limits.account = fields[1];
         }
 
-        // Parse TRES limits (cpu=X,node=Y,...)
-        auto parseTRES = [](const std::string& tres, int& cpus, int& nodes) {
-            std::regex cpu_re(R"(cpu=(\d+))");
-            std::regex node_re(R"(node=(\d+))");
-            std::smatch m;
-            if (std::regex_search(tres, m, cpu_re)) cpus = std::stoi(m[1]);
-            if (std::regex_search(tres, m, node_re)) nodes = std::stoi(m[1]);
-        };
-
-        if (fields.size() >= 3) parseTRES(fields[2], quota.max_cpus, quota.max_nodes);
-        if (fields.size() >= 4) parseTRES(fields[3], quota.max_cpus, quota.max_nodes);
+        // TRES limits (cpu=X,node=Y,mem=Z,gres/gpu=N,...); per-job limits override group ones
+        if (fields.size() >= 3) parseTresList(fields[2], limits.tres);
+        if (fields.size() >= 4) parseTresList(fields[3], limits.tres);
 
         // Parse job limits
         if (fields.size() >= 5 && !fields[4].empty()) {
-            try { quota.max_jobs = std::stoi(fields[4]); } catch (...) {}
+            try { limits.max_jobs = std::stoi(fields[4]); } catch (...) {}
         }
         if (fields.size() >= 6 && !fields[5].empty()) {
-            try { quota.max_jobs = std::max(quota.max_jobs, std::stoi(fields[5])); } catch (...) {}
+            try { limits.max_jobs = std::max(limits.max_jobs, std::stoi(fields[5])); } catch (...) {}
         }
     }
+    return limits;
+}
 
-    // Get current usage from squeue
-    cmd = "squeue -u " + std::string(user) + " -o \"%T %C\" --noheader 2>/dev/null";
-    out = execCmd(cmd);
-
-    std::istringstream iss2(out);
-    while (std::getline(iss2, line)) {
-        if (line.empty()) continue;
+using QuotaLimitsCache = api::SnapshotCache<QuotaLimits>;
 
-        std::istringstream lss(line);
-        std::string state;
-        int cpus = 0;
-        lss >> state >> cpus;
+// Shared by every quota view of the process
+inline QuotaLimitsCache& quotaLimits() {
+    static QuotaLimitsCache cache(&getQuotaLimits, std::chrono::hours(1));
+    return cache;
+}
 
-        if (state == "RUNNING") {
-            quota.used_cpus += cpus;
+// Limits (null until sacctmgr answered) and usage of the user's jobs, from
+// the user index of the job table (the table holds every user with --all)
+inline UserQuota getUserQuota(const QuotaLimits* limits, const api::JobTable& jobs) {
+    UserQuota quota;
+    quota.user = quotaUser();
+    if (limits) {
+        quota.account = limits->account;
+        quota.limits = limits->tres;
+        quota.max_jobs = limits->max_jobs;
+    }
+    for (uint32_t row : jobs.rows(api::JobTable::User, quota.user)) {
+        const auto& job = jobs.job(row);
+        if (job.state == "RUNNING") {
+            quota.used_cpus += job.cpus;
+            quota.used_nodes += job.nodes;
+            quota.used_mem_mb += job.mem_mb;
+            quota.used_gpus += job.gpus;
             quota.running_jobs++;
-        } else if (state == "PENDING") {
+        } else if (job.state == "PENDING") {
             quota.pending_jobs++;
         }
     }
-
-    // Get node count for running jobs
-    cmd = "squeue -u " + std::string(user) + " -t RUNNING -o \"%D\" --noheader 2>/dev/null";
-    out = execCmd(cmd);
-
-    std::istringstream iss3(out);
-    while (std::getline(iss3, line)) {
-        if (line.empty()) continue;
-        try { quota.used_nodes += std::stoi(line); } catch (...) {}
-    }
-
     return quota;
 }
 
-inline Element renderQuotaBar(int used, int max, Color base_color) {
+inline std::string formatMemoryMB(int64_t mb) {
+    char buf[32];
+    if (mb >= 1024 * 1024) std::snprintf(buf, sizeof(buf), "%.1fT", (double)mb / (1024 * 1024));
+    else if (mb >= 1024) std::snprintf(buf, sizeof(buf), "%.1fG", (double)mb / 1024);
+    else std::snprintf(buf, sizeof(buf), "%lldM", (long long)mb);
+    return buf;
+}
+
+inline Element renderQuotaBar(int64_t used, int64_t max, Color base_color,
+                              std::function<std::string(int64_t)> format = {}) {
     if (max <= 0) return text("N/A") | dim;
+    if (!format) format = [](int64_t v) { return std::to_string(v); };
 
     float ratio = (float)used / max;
     int bar_width = 30;
@@ -139,17 +171,51 @@ inline Element renderQuotaBar(int used, int max, Color base_color) {
     return hbox({
         text(bar) | color(bar_color),
         text(" "),
-        text(std::to_string(used) + "/" + std::to_string(max)) | bold,
+        text(format(used) + "/" + format(max)) | bold,
         text(" (" + std::to_string((int)(ratio * 100)) + "%)") | dim,
     });
 }
 
-inline Component quotaView(std::function<void()> on_close) {
-    auto quota = std::make_shared<UserQuota>(getUserQuota());
+// Used/limit bar and what is left of one TRES, or the usage alone without a limit
+inline Elements renderQuotaResource(const std::string& title, const std::string& unit, int64_t used, int64_t max,
+                                    Color base_color, std::function<std::string(int64_t)> format = {}) {
+    if (!format) format = [](int64_t v) { return std::to_string(v); };
+    std::string suffix = unit.empty() ? "" : " " + unit;
+    Elements rows;
+    rows.push_back(text(title) | bold | color(Color::Yellow));
+    if (max > 0) {
+        int64_t remaining = max - used;
+        rows.push_back(hbox({
+            text("  Used:      "),
+            renderQuotaBar(used, max, base_color, format),
+        }));
+        rows.push_back(hbox({
+            text("  Remaining: "),
+            text(format(remaining)) | bold | color(remaining > 0 ? Color::Green : Color::Red),
+            text(suffix + " available") | dim,
+        }));
+    } else {
+        rows.push_back(hbox({
+            text("  "),
+            text("No " + title.substr(0, title.find(' ')) + " limit configured") | dim,
+            text(" (using " + format(used) + suffix + ")") | color(Color::Cyan),
+        }));
+    }
+    rows.push_back(text(""));
+    return rows;
+}
+
+// Opens at once: limits come from the cached sacctmgr query (fetched in the
+// background when missing or old), usage from the job snapshot
+inline Component quotaView(std::shared_ptr<const api::JobTable> jobs, std::function<void()> on_close,
+                           std::function<void()> on_update = {}) {
+    auto& limits = quotaLimits();
+    limits.refreshIfStale(on_update);
 
-    auto content = Renderer([=] {
-        int remaining_cpus = quota->max_cpus > 0 ? quota->max_cpus - quota->used_cpus : -1;
-        int remaining_nodes = quota->max_nodes > 0 ? quota->max_nodes - quota->used_nodes : -1;
+    auto content = Renderer([=, &limits] {
+        auto snapshot = limits.get();
+        UserQuota quota = getUserQuota(snapshot.get(), *jobs);
+        auto memory = [](int64_t mb) { return formatMemoryMB(mb); };
 
         std::vector<Element> elements;
 
@@ -161,74 +227,58 @@ inline Component quotaView(std::function<void()> on_close) {
         // User info
         elements.push_back(hbox({
             text("User: ") | dim,
-            text(quota->user) | bold | color(Color::Magenta),
+            text(quota.user) | bold | color(Color::Magenta),
             text("  Account: ") | dim,
-            text(quota->account.empty() ? "default" : quota->account) | color(Color::Cyan),
+            text(quota.account.empty() ? "default" : quota.account) | color(Color::Cyan),
+            filler(),
+            (!snapshot ? text("loading limits...") | color(Color::Green)
+             : limits.refreshing() ? text("refreshing...") | color(Color::Green)
+                                   : text("")),
         }));
         elements.push_back(separator());
 
-        // CPU quota
-        elements.push_back(text("CPU Cores") | bold | color(Color::Yellow));
-        if (quota->max_cpus > 0) {
-            elements.push_back(hbox({
-                text("  Used:      "),
-                renderQuotaBar(quota->used_cpus, quota->max_cpus, Color::Green),
-            }));
-            elements.push_back(hbox({
-                text("  Remaining: "),
-                text(std::to_string(remaining_cpus)) | bold |
-                    color(remaining_cpus > 0 ? Color::Green : Color::Red),
-                text(" cores available") | dim,
-            }));
-        } else {
-            elements.push_back(hbox({
-                text("  "),
-                text("No CPU limit configured") | dim,
-                text(" (using " + std::to_string(quota->used_cpus) + " cores)") | color(Color::Cyan),
-            }));
-        }
-        elements.push_back(text(""));
-
-        // Node quota
-        elements.push_back(text("Nodes") | bold | color(Color::Yellow));
-        if (quota->max_nodes > 0) {
-            elements.push_back(hbox({
-                text("  Used:      "),
-                renderQuotaBar(quota->used_nodes, quota->max_nodes, Color::Blue),
-            }));
-            elements.push_back(hbox({
-                text("  Remaining: "),
-                text(std::to_string(remaining_nodes)) | bold |
-                    color(remaining_nodes > 0 ? Color::Green : Color::Red),
-                text(" nodes available") | dim,
-            }));
-        } else {
-            elements.push_back(hbox({
-                text("  "),
-                text("No node limit configured") | dim,
-                text(" (using " + std::to_string(quota->used_nodes) + " nodes)") | color(Color::Cyan),
-            }));
-        }
-        elements.push_back(text(""));
+        for (auto& row : renderQuotaResource("CPU Cores", "cores", quota.used_cpus, quota.limit("cpu"), Color::Green))
+            elements.push_back(row);
+        for (auto& row : renderQuotaResource("Nodes", "nodes", quota.used_nodes, quota.limit("node"), Color::Blue))
+            elements.push_back(row);
+        for (auto& row : renderQuotaResource("Memory", "", quota.used_mem_mb, quota.limit("mem"), Color::Cyan, memory))
+            elements.push_back(row);
+        for (auto& row : renderQuotaResource("GPUs", "GPUs", quota.used_gpus, quota.limit("gres/gpu"), Color::Magenta))
+            elements.push_back(row);
 
         // Job quota
         elements.push_back(text("Jobs") | bold | color(Color::Yellow));
-        int total_jobs = quota->running_jobs + quota->pending_jobs;
-        if (quota->max_jobs > 0) {
+        int total_jobs = quota.running_jobs + quota.pending_jobs;
+        if (quota.max_jobs > 0) {
             elements.push_back(hbox({
                 text("  Active:    "),
-                renderQuotaBar(total_jobs, quota->max_jobs, Color::Magenta),
+                renderQuotaBar(total_jobs, quota.max_jobs, Color::Magenta),
             }));
         }
         elements.push_back(hbox({
             text("  Running: ") | dim,
-            text(std::to_string(quota->running_jobs)) | color(Color::Green),
+            text(std::to_string(quota.running_jobs)) | color(Color::Green),
             text("  Pending: ") | dim,
-            text(std::to_string(quota->pending_jobs)) | color(Color::Yellow),
+            text(std::to_string(quota.pending_jobs)) | color(Color::Yellow),
         }));
 
+        // TRES limited without a row of their own (billing, licenses, ...)
+        std::string other;
+        for (const auto& [tres, value] : quota.limits) {
+            if (tres == "cpu" || tres == "node" || tres == "mem" || tres == "gres/gpu") continue;
+            other += (other.empty() ? "" : ", ") + tres + "=" + std::to_string(value);
+        }
+        if (!other.empty()) {
+            elements.push_back(hbox({text("  Other limits: ") | dim, text(other)}));
+        }
+
         // Warning if at limit
-        if (remaining_cpus == 0 || remaining_nodes == 0) {
+        bool at_limit = false;
+        for (auto [tres, used] : {std::pair<const char*, int64_t>{"cpu", quota.used_cpus}, {"node", quota.used_nodes},
+                                  {"mem", quota.used_mem_mb}, {"gres/gpu", quota.used_gpus}}) {
+            if (quota.limit(tres) > 0 && used >= quota.limit(tres)) at_limit = true;
+        }
+        if (at_limit) {
             elements.push_back(text(""));
             elements.push_back(
                 hbox({
@@ -244,7 +294,7 @@ inline Component quotaView(std::function<void()> on_close) {
         elements.push_back(separator());
         elements.push_back(hbox({
             text("r") | bold | color(Color::Yellow),
-            text(": refresh  ") | dim,
+            text(": refresh limits  ") | dim,
             text("Esc") | bold | color(Color::Yellow),
             text(": close") | dim,
         }) | center);
@@ -252,9 +302,9 @@ inline Component quotaView(std::function<void()> on_close) {
         return vbox(elements) | border | size(WIDTH, LESS_THAN, 70);
     });
 
-    return CatchEvent(content, [=](Event e) {
+    return CatchEvent(content, [=, &limits](Event e) {
         if (e == Event::Character('r') || e == Event::Character('R')) {
-            *quota = getUserQuota();
+            limits.refreshAsync(on_update);
             return true;
         }
         if (e == Event::Escape || e == Event::Return || e.is_character()) {
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <ftxui/dom/elements.hpp>
+#include <cstdint>
+#include <string>
+
+namespace ui {
+using namespace ftxui;
+
+// Memoizes an element tree on (job id, snapshot version). The tree is
+// rebuilt only when one of them changes; other frames (scrolling, resizes,
+// modal toggles, ...) reuse the same Element, which lays itself out for the
+// box it is given at render time.
+class RenderCache {
+public:
+    template <typename Build>
+    Element get(const std::string& job_id, uint64_t version, Build&& build) {
+        if (!element_ || job_id != job_id_ || version != version_) {
+            element_ = build();
+            job_id_ = job_id;
+            version_ = version;
+        }
+        return element_;
+    }
+
+    void clear() { element_ = nullptr; }
+
+private:
+    Element element_;
+    std::string job_id_;
+    uint64_t version_ = 0;
+};
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <algorithm>
+
+namespace ui {
+
+// Vertical scroll state in whole lines. `page` and `content` are refreshed by
+// the element on every layout; handlers only move `top`.
+struct LineViewport {
+    int top = 0;        // First visible line
+    int page = 0;       // Visible height at the last layout
+    int content = 0;    // Total height at the last layout
+
+    void scrollBy(int lines) { scrollTo(top + lines); }
+    void scrollTo(int line) { top = std::clamp(line, 0, std::max(0, content - page)); }
+    void pageUp() { scrollBy(-std::max(1, page - 2)); }
+    void pageDown() { scrollBy(std::max(1, page - 2)); }
+    void home() { top = 0; }
+    void end() { scrollTo(content); }
+    bool atEnd() const { return top >= content - page; }
+
+    // Percentage of the content above the bottom of the viewport
+    int percent() const {
+        if (content <= page) return 100;
+        return (int)(100LL * (top + page) / content);
+    }
+};
+
+}
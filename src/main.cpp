@@ -4,119 +4,186 @@
 #include <chrono>
 #include <thread>
 #include <atomic>
+#include <cstring>
 
 #include "api/slurmjobs.hpp"
+#include "api/job_table.hpp"
+#include "api/snapshot_cache.hpp"
 #include "components/jobdetails.hpp"
+#include "components/job_list.hpp"
 #include "components/nodedetails.hpp"
 #include "components/title.hpp"
 #include "components/footer.hpp"
 #include "components/cluster_view.hpp"
 #include "components/debug_view.hpp"
 #include "components/log_view.hpp"
+#include "components/multilog_view.hpp"
+#include "components/grep_view.hpp"
 #include "components/history_view.hpp"
+#include "components/efficiency_view.hpp"
 #include "components/quota_view.hpp"
+#include "components/heatmap_view.hpp"
+#include "components/frame_profiler.hpp"
+#include "components/render_cache.hpp"
 
 using namespace ftxui;
 
-int main() {
-    auto jobs = std::make_shared<std::vector<api::Job>>(api::slurm::getUserJobs());
-    if (jobs->empty()) {
-        std::cout << "No jobs found for current user\n";
+int main(int argc, char** argv) {
+    // --all: every user's jobs, for support staff
+    bool all_users = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--all") == 0 || std::strcmp(argv[i], "-a") == 0) {
+            all_users = true;
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--all]\n"
+                      << "  -a, --all   show the jobs of every user\n";
+            return std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0 ? 0 : 1;
+        }
+    }
+    auto fetch_jobs = [all_users] {
+        return all_users ? api::slurm::getAllJobs() : api::slurm::getUserJobs();
+    };
+
+    // Every job of the snapshot, indexed by user/account/partition/state/node;
+    // the sidebar lists the rows matching the filter (f) straight from it
+    auto table = std::make_shared<api::JobTable>();
+    table->update(fetch_jobs());
+    if (table->empty()) {
+        std::cout << (all_users ? "No jobs in the queue\n" : "No jobs found for current user\n");
         return 0;
     }
 
-    auto entries = std::make_shared<std::vector<std::string>>();
-    for (const auto& job : *jobs)
-        entries->push_back(job.name + " (" + job.id + ")");
+    auto job_list = std::make_shared<ui::JobListState>(table, all_users);
+    job_list->refresh();
+    std::string filter_query;
 
-    int selected = 0;
     bool show_help = false;
     bool show_partitions = false;
     bool show_debug = false;
     bool show_logs = false;
     auto log_show_stderr = std::make_shared<bool>(false);
-    auto log_scroll_y = std::make_shared<float>(0.f);
+    auto log_viewport = std::make_shared<ui::LogViewport>();
+    bool show_multilog = false;
+    bool show_grep = false;
     std::string status_message;
 
-    // Sort state
-    int sort_mode = 0;  // 0=none, 1=id, 2=name, 3=status
-
     // History state
     bool show_history = false;
+    bool show_efficiency = false;
 
     // Quota state
     bool show_quota = false;
 
+    // Cluster node heatmap state
+    bool show_heatmap = false;
+
     // Cancel confirmation state
     bool show_cancel_confirm = false;
     std::string cancel_job_id;
     std::string cancel_job_name;
 
+    // Jump-to-node prompt state
+    bool show_jump = false;
+    std::string jump_query;
+
+    // Job filter prompt state
+    bool show_filter = false;
+
     auto last_refresh = std::chrono::steady_clock::now();
     constexpr int AUTO_REFRESH_SECONDS = 30;
+    constexpr int MAX_FPS = 30;
+
+    // Bumped whenever the displayed job data changes, so unchanged frames can be reused
+    uint64_t snapshot_version = 0;
 
-    auto current_job = std::make_shared<api::DetailedJob>(api::slurm::getJobDetails((*jobs)[selected].id));
+    auto current_job = std::make_shared<api::DetailedJob>(api::slurm::getJobDetails(job_list->selected_id));
 
     ScreenInteractive screen = ScreenInteractive::Fullscreen();
 
-    // Refresh function
-    auto refresh_jobs = [&]() {
-        *jobs = api::slurm::getUserJobs();
-        entries->clear();
-        for (const auto& job : *jobs)
-            entries->push_back(job.name + " (" + job.id + ")");
+    ui::FrameProfiler profiler(std::chrono::milliseconds(1000 / MAX_FPS),
+                               [&] { screen.PostEvent(Event::Custom); });
+
+    // Redraw request from a background fetch; the frame cache must not replay the old frame
+    auto redraw_async = [&] {
+        screen.Post([&] { profiler.invalidate(); });
+        screen.PostEvent(Event::Custom);
+    };
+
+    // Partition data comes from a snapshot refreshed in the background, never from the render path
+    ui::PartitionSnapshot partitions(&api::slurm::getPartitions,
+                                     std::chrono::seconds(AUTO_REFRESH_SECONDS));
 
-        if (jobs->empty()) {
-            status_message = "No jobs";
+    // squeue (the whole queue with --all) runs and is parsed on a worker;
+    // the UI thread only applies its diff against the table
+    api::SnapshotCache<std::vector<api::Job>> queue(fetch_jobs, std::chrono::seconds(AUTO_REFRESH_SECONDS));
+    uint64_t applied_queue = 0;
+
+    // Applies the latest squeue snapshot, once
+    auto apply_jobs = [&]() {
+        if (queue.version() == applied_queue) return;
+        applied_queue = queue.version();
+        table->update(*queue.get());
+        job_list->refresh();
+
+        if (job_list->rows.empty()) {
+            status_message = job_list->filter.empty() ? "No jobs" : "No jobs match " + filter_query;
             return;
         }
 
-        if (selected >= (int)jobs->size()) {
-            selected = jobs->size() - 1;
-        }
-        *current_job = api::slurm::getJobDetails((*jobs)[selected].id);
+        // The selection stays on its job; its details are fetched again
+        *current_job = api::slurm::getJobDetails(job_list->selected_id);
+        snapshot_version++;
         last_refresh = std::chrono::steady_clock::now();
         status_message = "Refreshed!";
     };
 
+    // Refresh function
+    auto refresh_jobs = [&]() {
+        queue.refreshAsync([&] {
+            screen.Post([&] { apply_jobs(); });
+            redraw_async();
+        });
+    };
+
+    // Node panel scroll state, kept across snapshots of the same job. Declared
+    // before the cache: the cached grid reads it until the cache is destroyed.
+    ui::NodeGridView grid_view;
+
+    // Job panels are rebuilt only when the job or the snapshot changes
+    ui::RenderCache job_info_cache;
+    ui::RenderCache job_nodes_cache;
+
     Component job_info = Renderer([&] {
-        return ui::jobdetails(*current_job)->Render();
+        return job_info_cache.get(current_job->id, snapshot_version, [&] {
+            return ui::jobdetailsElement(*current_job);
+        });
     });
 
     Component job_nodes_content = Renderer([&] {
-        return ui::nodedetails(*current_job, screen.dimx())->Render();
+        return job_nodes_cache.get(current_job->id, snapshot_version, [&] {
+            return ui::nodeGrid(*current_job, &grid_view);
+        });
     });
 
-    float scroll_y = 0.f;
-
     Component job_nodes_scrollable = Renderer(job_nodes_content, [&] {
-        return job_nodes_content->Render()
-               | focusPositionRelative(0.f, scroll_y)
-               | frame
-               | flex;
+        return job_nodes_content->Render() | flex;
     });
 
     job_nodes_scrollable =
         CatchEvent(job_nodes_scrollable, [&](Event e) {
-            constexpr float wheel_step = 0.05f;
-            bool handled = false;
+            constexpr int wheel_step = 3;
 
             if (e.is_mouse()) {
                 if (e.mouse().button == Mouse::WheelDown) {
-                    scroll_y += wheel_step;
-                    handled = true;
+                    grid_view.scrollBy(wheel_step);
+                    return true;
                 }
                 if (e.mouse().button == Mouse::WheelUp) {
-                    scroll_y -= wheel_step;
-                    handled = true;
+                    grid_view.scrollBy(-wheel_step);
+                    return true;
                 }
             }
 
-            if (handled) {
-                scroll_y = std::clamp(scroll_y, 0.f, 1.f);
-                return true;
-            }
-
             return false;
         });
 
@@ -124,17 +191,11 @@ int main() {
         job_nodes_scrollable | flex,
     });
 
-    MenuOption menu_opt;
-    menu_opt.on_change = [&] {
-        if (!jobs->empty() && selected < (int)jobs->size()) {
-            *current_job = api::slurm::getJobDetails((*jobs)[selected].id);
-            scroll_y = 0.f;
-        }
-    };
-
-    Component sidebar =
-        Menu(entries.get(), &selected, menu_opt)
-        | size(WIDTH, EQUAL, 30);
+    Component sidebar = ui::jobList(job_list, [&] {
+        *current_job = api::slurm::getJobDetails(job_list->selected_id);
+        snapshot_version++;
+        grid_view.top = 0;
+    }) | size(WIDTH, EQUAL, 30);
 
     Component interface_job = Container::Vertical({
         job_info,
@@ -147,23 +208,31 @@ int main() {
         interface_job | flex,
     });
 
+    // Seconds shown before the next auto-refresh
+    auto next_refresh = [&] {
+        auto elapsed = std::chrono::steady_clock::now() - last_refresh;
+        return AUTO_REFRESH_SECONDS - (int)std::chrono::duration_cast<std::chrono::seconds>(elapsed).count();
+    };
+
     // Status bar with last refresh time
     Component status_bar = Renderer([&] {
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - last_refresh).count();
-        int next_refresh = AUTO_REFRESH_SECONDS - elapsed;
+
+        std::string shown = std::to_string(job_list->rows.size()) + " jobs";
+        if (!job_list->filter.empty()) shown += " of " + std::to_string(table->size()) + " [" + filter_query + "]";
 
         return hbox({
             text(" "),
             text(status_message) | color(Color::Green),
             filler(),
-            text("Auto-refresh: " + std::to_string(next_refresh) + "s") | dim,
+            text(shown) | dim,
+            text("  "),
+            text("Auto-refresh: " + std::to_string(next_refresh()) + "s") | dim,
             text("  "),
         });
     });
 
     Component main_content = Container::Vertical({
-        ui::title("Romeo Slurm Viewer (RSV) v1.0.0"),
+        ui::title(all_users ? "Romeo Slurm Viewer (RSV) v1.0.0 - all users" : "Romeo Slurm Viewer (RSV) v1.0.0"),
         interface_jobs | flex,
         status_bar,
         Renderer([] { return ui::footer(); }),
@@ -173,17 +242,22 @@ int main() {
     Component help = ui::helpModal([&] { show_help = false; });
 
     // Partition view
+    Component cluster_view = ui::clusterView(partitions);
     Component partition_view = Renderer([&] {
         return vbox({
             text("══════════ CLUSTER PARTITIONS ══════════") | bold | center | color(Color::Cyan),
             text(""),
-            ui::clusterView()->Render(),
+            cluster_view->Render(),
             text(""),
-            text("Press any key to close") | dim | center,
+            text("r: refresh now, any other key to close") | dim | center,
         }) | border | clear_under | center;
     });
 
     partition_view = CatchEvent(partition_view, [&](Event e) {
+        if (e == Event::Character('r') || e == Event::Character('R')) {
+            partitions.refreshAsync(redraw_async);
+            return true;
+        }
         if (e.is_character() || e == Event::Escape || e == Event::Return) {
             show_partitions = false;
             return true;
@@ -196,25 +270,66 @@ int main() {
         ui::debugView(current_job->id, [&] { show_debug = false; })
     );
 
-    // Log view (will be created dynamically based on selected job)
-    auto log_component = std::make_shared<Component>(
-        ui::logView(current_job->id, log_show_stderr, log_scroll_y, [&] { show_logs = false; })
-    );
-
-    // History view
-    auto history_scroll_y = std::make_shared<float>(0.f);
-    auto history_component = std::make_shared<Component>(
-        ui::historyView(history_scroll_y, [&] { show_history = false; })
-    );
-
-    // Quota view
-    auto quota_component = std::make_shared<Component>(
-        ui::quotaView([&] { show_quota = false; })
-    );
+    // Log view (created when opened, it starts indexing the log in the background)
+    auto log_component = std::make_shared<Component>();
+
+    // Merged live logs of an array/sweep (created when opened, dropped on close: it watches files)
+    auto multilog_component = std::make_shared<Component>();
+
+    // Grep across the logs of an array/sweep (created when opened, dropped on close: it stops the scan)
+    auto grep_component = std::make_shared<Component>();
+
+    // History view (created when opened, it syncs the history store in the background)
+    auto history_viewport = std::make_shared<ui::LineViewport>();
+    auto history_component = std::make_shared<Component>();
+
+    // Efficiency view (created when opened, from the same history store)
+    auto efficiency_component = std::make_shared<Component>();
+
+    // Quota view (created when opened); association limits are fetched now, in the background
+    auto quota_component = std::make_shared<Component>();
+    ui::quotaLimits().refreshAsync();
+
+    // Cluster node heatmap (loaded when opened)
+    auto heatmap_component = std::make_shared<Component>();
+
+    // Jump-to-node prompt
+    InputOption jump_opt;
+    jump_opt.multiline = false;
+    Component jump_input = Input(&jump_query, "node name (e.g. a045)", jump_opt);
+
+    // Job filter prompt, with the biggest groups of the current selection
+    Component filter_input = Input(&filter_query, "user:alice state:pending node:romeo-a045", jump_opt);
+    // Recounted only when the table or the applied filter changed, not per keystroke
+    uint64_t groups_version = UINT64_MAX;
+    std::string groups_filter;
+    Element groups_element;
+    auto filter_groups = [&]() -> Element {
+        std::string applied;
+        for (const auto& [index, key] : job_list->filter.terms) applied += std::to_string(index) + ":" + key + " ";
+        if (groups_element && groups_version == table->version() && groups_filter == applied) return groups_element;
+        groups_version = table->version();
+        groups_filter = applied;
+        const auto& rows = job_list->rows;
+        Elements lines;
+        for (auto index : {api::JobTable::State, api::JobTable::User, api::JobTable::Partition,
+                           api::JobTable::Account, api::JobTable::Node}) {
+            auto groups = table->groups(index, rows);
+            Elements cells = {text(std::string(" ") + api::JobTable::indexName(index)) | bold | size(WIDTH, EQUAL, 11)};
+            for (size_t i = 0; i < std::min<size_t>(groups.size(), 4); ++i) {
+                const auto& [key, count] = groups[i];
+                cells.push_back(text(key.empty() ? "(none)" : key) | color(Color::Cyan));
+                cells.push_back(text(" " + std::to_string(count) + "  ") | dim);
+            }
+            if (groups.size() > 4) cells.push_back(text("+" + std::to_string(groups.size() - 4)) | dim);
+            lines.push_back(hbox(cells));
+        }
+        return groups_element = vbox(lines);
+    };
 
     Component interface = Container::Tab({main_content, help, partition_view}, nullptr);
 
-    interface = Renderer(interface, [&] {
+    auto compose = [&]() -> Element {
         Element base = main_content->Render();
 
         if (show_help) {
@@ -241,18 +356,43 @@ int main() {
                 (*log_component)->Render() | clear_under | center,
             });
         }
+        if (show_multilog) {
+            return dbox({
+                base,
+                (*multilog_component)->Render() | clear_under | center,
+            });
+        }
+        if (show_grep) {
+            return dbox({
+                base,
+                (*grep_component)->Render() | clear_under | center,
+            });
+        }
         if (show_history) {
             return dbox({
                 base,
                 (*history_component)->Render() | clear_under | center,
             });
         }
+        if (show_efficiency) {
+            return dbox({
+                base,
+                (*efficiency_component)->Render() | clear_under | center,
+            });
+        }
         if (show_quota) {
             return dbox({
                 base,
                 (*quota_component)->Render() | clear_under | center,
             });
         }
+        if (show_heatmap) {
+            // Full screen: every node of the cluster needs the room
+            return dbox({
+                base,
+                (*heatmap_component)->Render() | clear_under,
+            });
+        }
         if (show_cancel_confirm) {
             return dbox({
                 base,
@@ -285,11 +425,56 @@ int main() {
                 }) | border | clear_under | center,
             });
         }
+        if (show_filter) {
+            return dbox({
+                base,
+                vbox({
+                    text(" Filter jobs ") | bold | color(Color::Cyan) | center,
+                    separator(),
+                    hbox({text(" > ") | color(Color::Yellow), filter_input->Render() | size(WIDTH, EQUAL, 50)}),
+                    separator(),
+                    filter_groups(),
+                    separator(),
+                    hbox({
+                        text("Enter") | bold | color(Color::Yellow),
+                        text(": apply (empty: all jobs)  ") | dim,
+                        text("Esc") | bold | color(Color::Yellow),
+                        text(": cancel") | dim,
+                    }) | center,
+                }) | border | clear_under | center | size(WIDTH, LESS_THAN, 100),
+            });
+        }
+        if (show_jump) {
+            return dbox({
+                base,
+                vbox({
+                    text(" Jump to node ") | bold | color(Color::Cyan) | center,
+                    separator(),
+                    hbox({text(" > ") | color(Color::Yellow), jump_input->Render() | size(WIDTH, EQUAL, 30)}),
+                    separator(),
+                    hbox({
+                        text("Enter") | bold | color(Color::Yellow),
+                        text(": jump  ") | dim,
+                        text("Esc") | bold | color(Color::Yellow),
+                        text(": cancel") | dim,
+                    }) | center,
+                }) | border | clear_under | center,
+            });
+        }
         return base;
+    };
+
+    interface = Renderer(interface, [&] {
+        // The status bar changes without an event or a new snapshot
+        std::string status = status_message + "\n" + std::to_string(next_refresh());
+        return profiler.frame(compose, screen.dimx(), screen.dimy(), snapshot_version, status);
     });
 
     // Handle keyboard events
     interface = CatchEvent(interface, [&](Event e) {
+        // Dirty tracking / wheel coalescing, never consumes the event
+        profiler.onEvent(e);
+
         // Handle modals first
         if (show_help) {
             if (e.is_character() || e == Event::Escape || e == Event::Return) {
@@ -299,6 +484,10 @@ int main() {
             return false;
         }
         if (show_partitions) {
+            if (e == Event::Character('r') || e == Event::Character('R')) {
+                partitions.refreshAsync(redraw_async);
+                return true;
+            }
             if (e.is_character() || e == Event::Escape || e == Event::Return) {
                 show_partitions = false;
                 return true;
@@ -316,14 +505,27 @@ int main() {
             // Let the log component handle all events (scrolling, tab, escape)
             return (*log_component)->OnEvent(e);
         }
+        if (show_multilog) {
+            return (*multilog_component)->OnEvent(e);
+        }
+        if (show_grep) {
+            return (*grep_component)->OnEvent(e);
+        }
         if (show_history) {
             // Let the history component handle all events (scrolling, escape)
             return (*history_component)->OnEvent(e);
         }
+        if (show_efficiency) {
+            return (*efficiency_component)->OnEvent(e);
+        }
         if (show_quota) {
             // Let the quota component handle its events
             return (*quota_component)->OnEvent(e);
         }
+        if (show_heatmap) {
+            // Let the heatmap handle scrolling, refresh and close
+            return (*heatmap_component)->OnEvent(e);
+        }
         if (show_cancel_confirm) {
             // Handle cancel confirmation
             if (e == Event::Character('y') || e == Event::Character('Y')) {
@@ -346,6 +548,39 @@ int main() {
             }
             return true;  // Consume all other keys
         }
+        if (show_jump) {
+            if (e == Event::Return) {
+                status_message = grid_view.jumpTo(jump_query) ? "Jumped to " + jump_query
+                                                              : "No node matching " + jump_query;
+                show_jump = false;
+                return true;
+            }
+            if (e == Event::Escape) {
+                show_jump = false;
+                return true;
+            }
+            jump_input->OnEvent(e);
+            return true;
+        }
+        if (show_filter) {
+            if (e == Event::Return) {
+                job_list->filter = api::JobTable::parseFilter(filter_query);
+                if (job_list->refresh() && !job_list->rows.empty()) {
+                    *current_job = api::slurm::getJobDetails(job_list->selected_id);
+                    snapshot_version++;
+                }
+                status_message = job_list->rows.empty() ? "No jobs match " + filter_query
+                                                        : std::to_string(job_list->rows.size()) + " jobs shown";
+                show_filter = false;
+                return true;
+            }
+            if (e == Event::Escape) {
+                show_filter = false;
+                return true;
+            }
+            filter_input->OnEvent(e);
+            return true;
+        }
 
         // Quit
         if (e == Event::Character('q') || e == Event::Character('Q') ||
@@ -360,6 +595,33 @@ int main() {
             return true;
         }
 
+        // Node panel paging and jump-to-node
+        if (e == Event::PageDown) {
+            grid_view.pageDown();
+            return true;
+        }
+        if (e == Event::PageUp) {
+            grid_view.pageUp();
+            return true;
+        }
+        if (e == Event::Character('g') || e == Event::Character('G')) {
+            jump_query.clear();
+            show_jump = true;
+            return true;
+        }
+
+        // Filter by user, account, partition, state or node
+        if (e == Event::Character('f') || e == Event::Character('F')) {
+            show_filter = true;
+            return true;
+        }
+
+        // Frame timings overlay
+        if (e == Event::Character('t') || e == Event::Character('T')) {
+            profiler.toggleOverlay();
+            return true;
+        }
+
         // Help
         if (e == Event::Character('h') || e == Event::Character('H') ||
             e == Event::Character('?')) {
@@ -370,9 +632,9 @@ int main() {
         // Cancel job - show confirmation
         if (e == Event::Character('c') || e == Event::Character('C') ||
             e == Event::Delete) {
-            if (!jobs->empty()) {
-                cancel_job_id = (*jobs)[selected].id;
-                cancel_job_name = (*jobs)[selected].name;
+            if (const api::Job* job = job_list->selectedJob()) {
+                cancel_job_id = job->id;
+                cancel_job_name = job->name;
                 show_cancel_confirm = true;
             }
             return true;
@@ -381,13 +643,14 @@ int main() {
         // Partitions view
         if (e == Event::Character('p') || e == Event::Character('P')) {
             show_partitions = true;
+            partitions.refreshIfStale(redraw_async);
             return true;
         }
 
         // Debug view
         if (e == Event::Character('d') || e == Event::Character('D')) {
-            if (!jobs->empty()) {
-                *debug_component = ui::debugView((*jobs)[selected].id, [&] { show_debug = false; });
+            if (const api::Job* job = job_list->selectedJob()) {
+                *debug_component = ui::debugView(job->id, [&] { show_debug = false; });
                 show_debug = true;
             }
             return true;
@@ -395,19 +658,54 @@ int main() {
 
         // Logs view
         if (e == Event::Character('l') || e == Event::Character('L')) {
-            if (!jobs->empty()) {
+            if (const api::Job* job = job_list->selectedJob()) {
                 *log_show_stderr = false;  // Reset to stdout
-                *log_scroll_y = 0.f;       // Reset scroll
-                *log_component = ui::logView((*jobs)[selected].id, log_show_stderr, log_scroll_y, [&] { show_logs = false; });
+                *log_viewport = ui::LogViewport{};  // Reset scroll
+                *log_component = ui::logView(job->id, log_show_stderr, log_viewport,
+                                             [&] { show_logs = false; }, redraw_async);
                 show_logs = true;
             }
             return true;
         }
 
+        // Merged live logs of the selected job's array or sweep (m for multiplexed)
+        if (e == Event::Character('m') || e == Event::Character('M')) {
+            if (const api::Job* job = job_list->selectedJob()) {
+                *log_viewport = ui::LogViewport{};
+                *multilog_component = ui::multiLogView(job->id, job->user, log_viewport, [&] {
+                    show_multilog = false;
+                    // Free its buffers, after the handler that is running inside it
+                    screen.Post([&] { *multilog_component = Component(); });
+                }, redraw_async);
+                show_multilog = true;
+            }
+            return true;
+        }
+
+        // Grep every log of the selected job's array or sweep; a hit opens the log view on top
+        if (e == Event::Character('/')) {
+            if (const api::Job* job = job_list->selectedJob()) {
+                auto open = [&](const ui::GrepTarget& target, uint64_t line, const std::string& needle) {
+                    *log_show_stderr = target.stderr_file;
+                    *log_viewport = ui::LogViewport{};
+                    *log_component = ui::logView(target.job.id, {target.job.stdout_path, target.job.stderr_path},
+                                                 log_show_stderr, log_viewport, [&] { show_logs = false; },
+                                                 redraw_async, (int64_t)line, needle);
+                    show_logs = true;
+                };
+                *grep_component = ui::grepView(job->id, job->user, open, [&] {
+                    show_grep = false;
+                    screen.Post([&] { *grep_component = Component(); });
+                }, redraw_async);
+                show_grep = true;
+            }
+            return true;
+        }
+
         // Copy job ID (y for yank)
         if (e == Event::Character('y') || e == Event::Character('Y')) {
-            if (!jobs->empty()) {
-                std::string job_id = (*jobs)[selected].id;
+            if (const api::Job* job = job_list->selectedJob()) {
+                std::string job_id = job->id;
                 // Use xclip/xsel on Linux, pbcopy on Mac, clip on Windows
                 #ifdef _WIN32
                 std::string cmd = "echo " + job_id + " | clip";
@@ -424,54 +722,38 @@ int main() {
 
         // Sort jobs (s cycles through sort modes)
         if (e == Event::Character('s') || e == Event::Character('S')) {
-            sort_mode = (sort_mode + 1) % 4;
-            auto& j = *jobs;
-            switch (sort_mode) {
-                case 1:  // Sort by ID
-                    std::sort(j.begin(), j.end(), [](const api::Job& a, const api::Job& b) {
-                        return std::stoi(a.id) < std::stoi(b.id);
-                    });
-                    status_message = "Sort: ID";
-                    break;
-                case 2:  // Sort by name
-                    std::sort(j.begin(), j.end(), [](const api::Job& a, const api::Job& b) {
-                        return a.name < b.name;
-                    });
-                    status_message = "Sort: Name";
-                    break;
-                case 3:  // Sort by entry (original)
-                    std::sort(j.begin(), j.end(), [](const api::Job& a, const api::Job& b) {
-                        return a.entry_name < b.entry_name;
-                    });
-                    status_message = "Sort: Entry";
-                    break;
-                default:
-                    refresh_jobs();  // Reset to original order
-                    status_message = "Sort: Default";
-                    break;
-            }
-            // Rebuild entries
-            entries->clear();
-            for (const auto& job : *jobs)
-                entries->push_back(job.name + " (" + job.id + ")");
-            if (!jobs->empty()) {
-                selected = 0;
-                *current_job = api::slurm::getJobDetails((*jobs)[selected].id);
-            }
+            // Only the row ids are re-sorted; the selection stays on its job
+            job_list->sort = (ui::JobListState::Sort)((job_list->sort + 1) % ui::JobListState::SORTS);
+            job_list->refresh();
+            status_message = std::string("Sort: ") + ui::JobListState::sortName(job_list->sort);
             return true;
         }
 
         // History view (a for archive/history)
         if (e == Event::Character('a') || e == Event::Character('A')) {
-            *history_scroll_y = 0.f;
-            *history_component = ui::historyView(history_scroll_y, [&] { show_history = false; });
+            *history_viewport = ui::LineViewport{};
+            *history_component = ui::historyView(history_viewport, [&] { show_history = false; }, redraw_async);
             show_history = true;
             return true;
         }
 
+        // Efficiency and sbatch recommendations (e)
+        if (e == Event::Character('e') || e == Event::Character('E')) {
+            *efficiency_component = ui::efficiencyView([&] { show_efficiency = false; }, redraw_async);
+            show_efficiency = true;
+            return true;
+        }
+
+        // Cluster node heatmap (n for nodes)
+        if (e == Event::Character('n') || e == Event::Character('N')) {
+            *heatmap_component = ui::heatmapView([&] { show_heatmap = false; }, redraw_async);
+            show_heatmap = true;
+            return true;
+        }
+
         // Quota view (u for user quota)
         if (e == Event::Character('u') || e == Event::Character('U')) {
-            *quota_component = ui::quotaView([&] { show_quota = false; });
+            *quota_component = ui::quotaView(table, [&] { show_quota = false; }, redraw_async);
             show_quota = true;
             return true;
         }
@@ -485,7 +767,10 @@ int main() {
         while (running) {
             std::this_thread::sleep_for(std::chrono::seconds(AUTO_REFRESH_SECONDS));
             if (running) {
-                screen.Post([&] { refresh_jobs(); });
+                screen.Post([&] {
+                    refresh_jobs();
+                    if (show_partitions) partitions.refreshAsync(redraw_async);
+                });
                 screen.Post(Event::Custom);
             }
         }
@@ -495,6 +780,11 @@ int main() {
 
     running = false;
     refresh_thread.join();
+    // Their background fetches call redraw_async, which captures the screen
+    queue.stop();
+    api::HistoryStore::shutdown();
+    ui::quotaLimits().stop();
+    ui::nodeTables().stop();
 
     return 0;
 }